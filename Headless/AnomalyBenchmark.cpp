@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+// Checks the fused anomaly conversions (TrueAnomaly2 and MeanAnomaly4) against the chains of calls they replace, over a
+// grid of eccentricities and anomalies, and then times both. Exits with 1 if they disagree. Usage:
+// AnomalyBenchmark [repetitions], where 0 only runs the checks.
+
+#include <PrecompiledBoostOrbiter.h>
+#include <OrbitalMath/OrbitalMath.h>
+
+#include <chrono>
+
+using namespace std;
+using namespace OrbitalMath;
+using namespace OrbitalMath::OrbitalFunc;
+
+static const double ellipticEccentricities[] = { 0, 0.001, 0.01, 0.1, 0.3, 0.5, 0.7, 0.9, 0.99, 0.999 };
+static const double hyperbolicEccentricities[] = { 1.001, 1.01, 1.1, 1.5, 2, 5, 10 };
+
+// The difference between two angles, in the range -PI..PI
+static double angleDiff(double a, double b)
+{
+    return remainder(a - b, 2*PI);
+}
+
+// TrueAnomaly1 returns the true anomaly on the 0..PI half of the orbit; this puts it on the half the body is on
+static double chainedTrueAnomaly(double e, double M)
+{
+    double v = TrueAnomaly1(e, EccentricAnomaly1(e, M));
+    bool outbound = e < 1 ? sin(M) >= 0 : M >= 0;
+    return outbound ? v : -v;
+}
+
+static double chainedMeanAnomaly(double e, double v)
+{
+    return MeanAnomaly2(e, EccentricAnomaly2(e, v));
+}
+
+class errorStats
+{
+public:
+    errorStats(const char* name, double tolerance) : _name(name), _tolerance(tolerance), _max(0), _count(0), _failed(0) { }
+
+    void Add(double error, double e, double anomaly)
+    {
+        error = abs(error);
+        _count++;
+        if (!(error <= _tolerance))
+        {
+            if (_failed++ < 5)
+                fprintf(stderr, "  %s: e = %g, anomaly = %.17g is off by %g\n", _name, e, anomaly, error);
+        }
+        if (error > _max)
+            _max = error;
+    }
+
+    bool Report()
+    {
+        printf("%-56s %6d points, max difference %.2e (tolerance %.0e)%s\n", _name, _count, _max, _tolerance,
+            _failed ? " FAILED" : "");
+        return _failed == 0;
+    }
+
+private:
+    const char* _name;
+    double _tolerance, _max;
+    int _count, _failed;
+};
+
+static bool check()
+{
+    // TrueAnomaly1 uses acos, which loses precision near the apsides, hence the looser tolerance
+    errorStats trueElliptic("TrueAnomaly2 vs TrueAnomaly1(EccentricAnomaly1), e < 1", 1e-8);
+    errorStats trueHyperbolic("TrueAnomaly2 vs TrueAnomaly1(EccentricAnomaly1), e > 1", 1e-8);
+    errorStats meanElliptic("MeanAnomaly4 vs MeanAnomaly2(EccentricAnomaly2), e < 1", 1e-10);
+    errorStats roundTrip("MeanAnomaly4(TrueAnomaly2(M)) vs M", 1e-10);
+
+    for (size_t i = 0; i < sizeof(ellipticEccentricities) / sizeof(ellipticEccentricities[0]); i++)
+    {
+        double e = ellipticEccentricities[i];
+        for (int j = -600; j <= 600; j++)
+        {
+            double M = j * (3*PI / 600) + 1e-3; // a few orbits either way, avoiding the exact apsides
+            double v = TrueAnomaly2(e, M);
+            trueElliptic.Add(angleDiff(v, chainedTrueAnomaly(e, M)), e, M);
+            roundTrip.Add(angleDiff(MeanAnomaly4(e, v), M), e, M);
+        }
+        for (int j = -599; j <= 599; j++)
+        {
+            double v = j * (PI / 600); // EccentricAnomaly2 breaks down at the apoapsis
+            meanElliptic.Add(angleDiff(MeanAnomaly4(e, v), chainedMeanAnomaly(e, v)), e, v);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(hyperbolicEccentricities) / sizeof(hyperbolicEccentricities[0]); i++)
+    {
+        double e = hyperbolicEccentricities[i];
+        for (int j = -500; j <= 500; j++)
+        {
+            double M = j * 0.1 + 1e-3;
+            double v = TrueAnomaly2(e, M);
+            trueHyperbolic.Add(angleDiff(v, chainedTrueAnomaly(e, M)), e, M);
+            roundTrip.Add((MeanAnomaly4(e, v) - M) / max(1.0, abs(M)), e, M);
+        }
+    }
+
+    bool ok = trueElliptic.Report();
+    ok = trueHyperbolic.Report() && ok;
+    ok = meanElliptic.Report() && ok;
+    ok = roundTrip.Report() && ok;
+    return ok;
+}
+
+// Times func over every anomaly for every eccentricity, "repetitions" times, and returns nanoseconds per call
+template<class TFunc>
+static double timeCalls(const double* eccentricities, size_t eccentricityCount, const vector<double>& anomalies,
+    vector<double>& results, int repetitions, TFunc func)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++)
+        for (size_t i = 0; i < eccentricityCount; i++)
+            func(eccentricities[i], &anomalies[0], &results[0], (int) anomalies.size());
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return seconds / ((double) repetitions * eccentricityCount * anomalies.size()) * 1e9;
+}
+
+static void benchmark(int repetitions)
+{
+    vector<double> meanAnomalies, trueAnomalies, results(1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        meanAnomalies.push_back((i - 500) * (PI / 500) + 1e-3);
+        trueAnomalies.push_back((i - 500) * (0.999 * PI / 500));
+    }
+    size_t ellipticCount = sizeof(ellipticEccentricities) / sizeof(ellipticEccentricities[0]);
+    size_t hyperbolicCount = sizeof(hyperbolicEccentricities) / sizeof(hyperbolicEccentricities[0]);
+
+    printf("\nNanoseconds per conversion, %d repetitions:\n", repetitions);
+    printf("%-56s %10s %10s %10s\n", "", "chained", "fused", "fused x N");
+
+    printf("%-56s", "true from mean anomaly, e < 1");
+    printf(" %10.1f", timeCalls(ellipticEccentricities, ellipticCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { for (int i = 0; i < n; i++) v[i] = TrueAnomaly1(e, EccentricAnomaly1(e, M[i])); }));
+    printf(" %10.1f", timeCalls(ellipticEccentricities, ellipticCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { for (int i = 0; i < n; i++) v[i] = TrueAnomaly2(e, M[i]); }));
+    printf(" %10.1f\n", timeCalls(ellipticEccentricities, ellipticCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { TrueAnomaly2(e, M, v, n); }));
+
+    printf("%-56s", "true from mean anomaly, e > 1");
+    printf(" %10.1f", timeCalls(hyperbolicEccentricities, hyperbolicCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { for (int i = 0; i < n; i++) v[i] = TrueAnomaly1(e, EccentricAnomaly1(e, M[i])); }));
+    printf(" %10.1f", timeCalls(hyperbolicEccentricities, hyperbolicCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { for (int i = 0; i < n; i++) v[i] = TrueAnomaly2(e, M[i]); }));
+    printf(" %10.1f\n", timeCalls(hyperbolicEccentricities, hyperbolicCount, meanAnomalies, results, repetitions,
+        [](double e, const double* M, double* v, int n) { TrueAnomaly2(e, M, v, n); }));
+
+    printf("%-56s", "mean from true anomaly, e < 1");
+    printf(" %10.1f", timeCalls(ellipticEccentricities, ellipticCount, trueAnomalies, results, repetitions,
+        [](double e, const double* v, double* M, int n) { for (int i = 0; i < n; i++) M[i] = MeanAnomaly2(e, EccentricAnomaly2(e, v[i])); }));
+    printf(" %10.1f", timeCalls(ellipticEccentricities, ellipticCount, trueAnomalies, results, repetitions,
+        [](double e, const double* v, double* M, int n) { for (int i = 0; i < n; i++) M[i] = MeanAnomaly4(e, v[i]); }));
+    printf(" %10.1f\n", timeCalls(ellipticEccentricities, ellipticCount, trueAnomalies, results, repetitions,
+        [](double e, const double* v, double* M, int n) { MeanAnomaly4(e, v, M, n); }));
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? atoi(argv[1]) : 200;
+    bool ok = check();
+    if (repetitions > 0)
+        benchmark(repetitions);
+    return ok ? 0 : 1;
+}
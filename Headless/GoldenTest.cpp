@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+// Draws the test page on the software Sketchpad and compares it with the reference image, then draws it again with the
+// same helper re-attached to the cleared Sketchpad, as MfdBase does every frame, and compares that too. Usage:
+//   GoldenTest <reference.ppm>            exits with 0 if both images match; otherwise saves the first one that doesn't
+//                                         in the current directory as <reference>.actual.ppm, for inspection, and
+//                                         exits with 1
+//   GoldenTest <reference.ppm> --update   overwrites the reference with the current image
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TestPage.h"
+
+using namespace std;
+using namespace borb;
+
+// Returns true if the sketchpad matches the reference; otherwise reports the difference and saves the image
+static bool compare(Sketchpad& sketchpad, const string& reference, const char* frame)
+{
+    int differences = sketchpad.ComparePPM(reference);
+    if (differences == 0)
+    {
+        printf("The %s frame matches %s\n", frame, reference.c_str());
+        return true;
+    }
+    string actual = reference.substr(reference.find_last_of("/\\") + 1) + ".actual.ppm";
+    sketchpad.SavePPM(actual);
+    if (differences < 0)
+        fprintf(stderr, "Can't read %s, or it has a different size; the %s frame was saved as %s\n", reference.c_str(), frame, actual.c_str());
+    else
+        fprintf(stderr, "In the %s frame, %d pixels differ from %s; it was saved as %s\n", frame, differences, reference.c_str(), actual.c_str());
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: GoldenTest <reference.ppm> [--update]\n");
+        return 2;
+    }
+    string reference = argv[1];
+
+    Sketchpad sketchpad(TestPage::Width, TestPage::Height);
+    SketchpadHelper skh(&sketchpad, TestPage::Width, TestPage::Height);
+    TestPage page;
+    page.Draw(&skh);
+
+    if (argc > 2 && string(argv[2]) == "--update")
+    {
+        if (!sketchpad.SavePPM(reference))
+        {
+            fprintf(stderr, "Can't write %s\n", reference.c_str());
+            return 2;
+        }
+        printf("Updated %s\n", reference.c_str());
+        return 0;
+    }
+
+    if (!compare(sketchpad, reference, "first"))
+        return 1;
+
+    // The second frame reuses the helper's state, resources, cached sections and buffers from the first
+    sketchpad.Clear();
+    skh.Attach(&sketchpad, TestPage::Width, TestPage::Height);
+    page.Draw(&skh);
+    return compare(sketchpad, reference, "second") ? 0 : 1;
+}
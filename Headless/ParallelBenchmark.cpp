@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+// Times VesselAttached::PreStep for a type with the phased PreStep (see VesselAttachedParallel), run serially and with
+// WorkerPools of increasing size, for several amounts of work per vessel. The vessels are stand-ins and the compute
+// phase is a Kepler-equation solve repeated a number of times, so no Orbiter API is involved. Also checks that every
+// run gives the same results as the serial one. Usage: ParallelBenchmark [vessels] [frames] [max threads]
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include <chrono>
+
+// The parts of the Orbiter API and of borb that VesselAttached refers to, for SaveTo and LoadFrom, which aren't used here
+class VESSEL
+{
+public:
+    double MeanAnomaly, Eccentricity, Result;
+};
+typedef void* OBJHANDLE;
+inline VESSEL* oapiGetVesselInterface(OBJHANDLE) { return NULL; }
+
+namespace borb {
+    struct ScenarioNode
+    {
+        typedef std::map<std::string, ScenarioNode*>::iterator iterator_named;
+        std::map<std::string, ScenarioNode*> NamedChildren;
+    };
+    inline OBJHANDLE GetVesselByName(const std::string&) { return NULL; }
+}
+
+#include <borb/VesselAttached.h>
+#include <borb/WorkerPool.h>
+
+using namespace std;
+using namespace borb;
+
+static int workPerVessel;
+
+class syntheticTracker : private boost::noncopyable
+{
+public:
+    syntheticTracker(VESSEL* vessel) : _vessel(vessel), _meanAnomaly(0), _eccentricity(0), _result(0) { }
+
+    void PreStepGather(double simt, double simdt, double mjd)
+    {
+        _meanAnomaly = _vessel->MeanAnomaly + simt * 1e-3;
+        _eccentricity = _vessel->Eccentricity;
+    }
+
+    void PreStepCompute(double simt, double simdt, double mjd)
+    {
+        double sum = 0;
+        for (int i = 0; i < workPerVessel; i++)
+        {
+            double meanAnomaly = _meanAnomaly + i * 1e-4;
+            double E = meanAnomaly;
+            for (int iteration = 0; iteration < 4; iteration++)
+                E -= (E - _eccentricity * sin(E) - meanAnomaly) / (1 - _eccentricity * cos(E));
+            sum += E;
+        }
+        _result = sum;
+    }
+
+    void PreStepApply(double simt, double simdt, double mjd)
+    {
+        _vessel->Result = _result;
+    }
+
+    void PostStepGather(double simt, double simdt, double mjd) { }
+    void PostStepCompute(double simt, double simdt, double mjd) { }
+    void PostStepApply(double simt, double simdt, double mjd) { }
+
+private:
+    VESSEL* _vessel;
+    double _meanAnomaly, _eccentricity, _result;
+};
+
+namespace borb {
+    template<> struct VesselAttachedParallel<syntheticTracker> { enum { Enabled = true }; };
+}
+
+// Runs the frames, and returns the average time per frame in microseconds
+static double timeFrames(VesselAttached<syntheticTracker>& trackers, int frames, WorkerPool* pool)
+{
+    trackers.PreStep(0, 0.02, 0, pool); // warm-up; also starts the pool's threads
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+        trackers.PreStep(i * 0.02, 0.02, 0, pool);
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count() / frames * 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    int vesselCount = argc > 1 ? atoi(argv[1]) : 1000;
+    int frames = argc > 2 ? atoi(argv[2]) : 200;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : (int) thread::hardware_concurrency();
+    vesselCount = max(1, vesselCount);
+    frames = max(1, frames);
+    maxThreads = max(1, maxThreads);
+
+    vector<VESSEL> vessels(vesselCount);
+    VesselAttached<syntheticTracker> trackers;
+    for (int i = 0; i < vesselCount; i++)
+    {
+        vessels[i].MeanAnomaly = i * 0.01;
+        vessels[i].Eccentricity = (i % 90) * 0.01;
+        trackers.Get(&vessels[i]);
+    }
+
+    printf("%d vessels, %d frames, %d hardware threads; microseconds per PreStep:\n", vesselCount, frames,
+        (int) thread::hardware_concurrency());
+    printf("%10s %10s", "work", "serial");
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+        printf(" %6d thr", threads);
+    printf("\n");
+
+    bool mismatch = false;
+    const int works[] = { 1, 10, 100 };
+    for (size_t w = 0; w < sizeof(works) / sizeof(works[0]); w++)
+    {
+        workPerVessel = works[w];
+        printf("%10d %10.1f", workPerVessel, timeFrames(trackers, frames, NULL));
+        vector<double> expected(vesselCount);
+        for (int i = 0; i < vesselCount; i++)
+            expected[i] = vessels[i].Result;
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            WorkerPool pool(threads);
+            printf(" %10.1f", timeFrames(trackers, frames, &pool));
+            for (int i = 0; i < vesselCount; i++)
+                mismatch |= vessels[i].Result != expected[i];
+        }
+        printf("\n");
+    }
+
+    if (mismatch)
+    {
+        fprintf(stderr, "The parallel results differ from the serial ones\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+// Times drawing the test page on the software Sketchpad, i.e. everything an MFD's Update does except the final
+// rasterization by Orbiter or GDI, and then drawing a TimeSeriesPlot of 100000 samples, whole and zoomed in.
+// Usage: RenderBenchmark [frames]
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TestPage.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace borb;
+
+// Draws the plot's time range on every frame, and returns the average time per frame in microseconds
+static double timePlot(Sketchpad& sketchpad, SketchpadHelper& skh, TimeSeriesPlot& plot, double timeFrom, double timeTo, int frames)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        sketchpad.Clear();
+        skh.Attach(&sketchpad, TestPage::Width, TestPage::Height);
+        double lo, hi;
+        plot.GetRange(timeFrom, timeTo, lo, hi);
+        skh.SetPen(MfdColorGreen);
+        plot.Draw(&skh, 0.5, 0.5, 19.5, 19.5, timeFrom, timeTo, lo, hi);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count() / frames * 1e6;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames <= 0)
+        frames = 1;
+
+    Sketchpad sketchpad(TestPage::Width, TestPage::Height);
+    SketchpadHelper skh(&sketchpad, TestPage::Width, TestPage::Height);
+    TestPage page;
+
+    // As in MfdBase, one helper is attached to a fresh Sketchpad every frame, keeping its resources and buffers
+    double best = 1e300, total = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        sketchpad.Clear();
+        skh.Attach(&sketchpad, TestPage::Width, TestPage::Height);
+        page.Draw(&skh);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        total += seconds;
+        best = min(best, seconds);
+    }
+    printf("%d frames of %dx%d: %.1f us per frame on average, %.1f us at best\n",
+        frames, (int) TestPage::Width, (int) TestPage::Height, total / frames * 1e6, best * 1e6);
+
+    // A random walk, so that every column has a different range
+    TimeSeriesPlot plot;
+    unsigned seed = 12345;
+    double value = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        value += (int) ((seed >> 16) % 201) - 100;
+        plot.Add(i * 0.01, value);
+    }
+    printf("TimeSeriesPlot of %d samples: %.1f us per frame for all of them, %.1f us for the last 1%%\n", plot.GetCount(),
+        timePlot(sketchpad, skh, plot, 0, 1000, frames), timePlot(sketchpad, skh, plot, 990, 1000, frames));
+    return 0;
+}
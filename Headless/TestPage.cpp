@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TestPage.h"
+
+namespace borb {
+
+    using namespace std;
+
+    TestPage::TestPage()
+    {
+        // A noisy sawtooth, as a stand-in for some telemetry
+        unsigned seed = 12345;
+        for (int i = 0; i < 20000; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            int noise = (int) ((seed >> 16) % 200) - 100;
+            _plot.Add(i * 0.01, (i % 5000) + noise);
+        }
+        for (int i = 0; i <= 400; i++)
+        {
+            int t = i % 100;
+            _track.push_back(VECTOR2(1 + i * 0.045, 12.7 - (t < 50 ? t : 100 - t) * 0.03));
+        }
+        // A densely sampled, tilted ellipse, which leaves the display on the left and right and comes back. It uses the
+        // rational parametrization instead of sin and cos, and a tilt whose sine and cosine are rational too.
+        for (int i = 0; i <= 2000; i++)
+        {
+            double t = (i - (i < 1000 ? 500 : 1500)) / 500.0;
+            double x = 12 * (1 - t * t) / (1 + t * t), y = 1.4 * 2 * t / (1 + t * t);
+            if (i >= 1000)
+            {
+                x = -x;
+                y = -y;
+            }
+            _orbit.push_back(VECTOR2(10 + (x * 399 - y * 40) / 401, 12.3 + (x * 40 + y * 399) / 401));
+        }
+    }
+
+    void TestPage::Draw(SketchpadHelper* skh)
+    {
+        if (skh->BeginSection(_header, 1))
+        {
+            skh->SetFontProportional()->SetTextColor(MfdColorWhite);
+            skh->DrawTextLine(10, 0.3, "TEST PAGE", HA_CENTER, VA_TOP);
+            skh->SetPen(MfdColorGrey)->DrawLine(0.5, 1.5, 19.5, 1.5);
+            skh->EndSection();
+        }
+
+        skh->SetFontMonospace()->SetTextColor(MfdColorGreen);
+        skh->DrawTextLine(0.5, 1.8, "ALT 12345");
+        skh->SetTextColor(MfdColorYellow)->DrawTextLine(19.5, 1.8, "VS -3.2", HA_RIGHT, VA_TOP);
+        skh->SetTextColor(MfdColorRed)->SetTextBackColor(MfdColorBlueDark)->DrawTextLine(0.5, 3.1, "WARN");
+        skh->SetTextBackTransparent();
+
+        // Gauges, drawn as a batch so the pen and brush changes are grouped
+        skh->BeginBatch();
+        for (int i = 0; i < 4; i++)
+        {
+            double x = 1 + i * 4.7;
+            skh->SetPen(MfdColorGreenDark)->SetBrush(MfdColorGreyDarkDark)->DrawRectangle(x, 4.5, x + 3.5, 8);
+            skh->SetPen(MfdColorWhite)->SetBrush(i % 2 == 0 ? MfdColorGreen : MfdColorYellowDark)->DrawRectangle(x + 0.5, 8 - (i + 1) * 0.8, x + 3, 8);
+            skh->SetPen(MfdColorYellow, true)->DrawLine(x, 5.5, x + 3.5, 5.5);
+        }
+        skh->EndBatch();
+
+        skh->SetPen(MfdColorBlue)->SetBrush(MfdColorBlueDark)->DrawEllipse(13.5, 8.7, 16.5, 11.7);
+        VECTOR2 triangle[] = { VECTOR2(17, 8.7), VECTOR2(19.5, 11.7), VECTOR2(17, 11.7) };
+        skh->SetPen(MfdColorRed)->SetBrush(MfdColorRedDark)->DrawPolygon(triangle, 3);
+        skh->SetBrush(NULL);
+
+        skh->SetPen(MfdColorYellow)->DrawPolyline(_track);
+        skh->SetPolylineSimplification(true);
+        skh->SetPen(MfdColorWhite)->DrawPolyline(_orbit);
+        skh->SetPolylineSimplification(false);
+        skh->SetPen(MfdColorGreenDark);
+        skh->LineMoveTo(0.5, 9)->LineDrawTo(12, 9)->LineDrawTo(12, 10.5);
+
+        // Two minutes of the samples, with the grid behind them
+        double x1 = 1.5, y1 = 15, x2 = 19.5, y2 = 19.5;
+        double lo, hi;
+        _plot.GetRange(40, 160, lo, hi);
+        skh->SetPen(MfdColorGreyDark);
+        _plot.DrawGrid(skh, x1, y1, x2, y2, 40, 160, lo, hi);
+        skh->SetPen(MfdColorGreen);
+        _plot.Draw(skh, x1, y1, x2, y2, 40, 160, lo, hi);
+        vector<double> ticks;
+        double spacing = TimeSeriesPlot::MakeTicks(lo, hi, 5, ticks);
+        skh->SetFontMonospace()->SetTextColor(MfdColorGrey);
+        skh->DrawTextLine(x1, y1 - 1.3, "MAX " + TimeSeriesPlot::FormatTick(ticks.back(), spacing));
+    }
+
+}
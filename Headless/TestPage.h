@@ -0,0 +1,38 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include <borb/DisplayList.h>
+#include <borb/SketchpadHelper.h>
+#include <borb/SoftwareSketchpad.h>
+#include <borb/TimeSeriesPlot.h>
+
+namespace borb {
+
+    // A page that exercises most of what SketchpadHelper can draw: text in both fonts and alignments, lines, dashed
+    // pens, filled shapes, a long polyline, a simplified polyline that leaves the display and comes back, a batch, a
+    // display list section and a TimeSeriesPlot with its grid. The samples are generated without library functions
+    // such as sin, so the image is the same on every platform.
+    class TestPage
+    {
+    public:
+        enum { Width = 256, Height = 256 };
+
+        TestPage();
+
+        // Draws the page on a cleared Sketchpad of Width x Height.
+        void Draw(SketchpadHelper* skh);
+
+    private:
+        TimeSeriesPlot _plot;
+        std::vector<VECTOR2> _track;
+        std::vector<VECTOR2> _orbit;
+        DisplayList _header;
+    };
+
+}
@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+// Checks TimeSeriesPlot::GetRange, which reads the min/max pyramid, against a scan of every sample, for random time
+// ranges after samples are added, after the capacity trims the oldest ones and after RemoveBefore. Exits with 1 if
+// any range differs.
+
+#include <PrecompiledBoostOrbiter.h>
+#include <borb/TimeSeriesPlot.h>
+
+using namespace std;
+using namespace borb;
+
+// A fixed generator, so that every run checks the same ranges
+static unsigned seed = 12345;
+static double randomBetween(double from, double to)
+{
+    seed = seed * 1103515245 + 12345;
+    return from + (to - from) * ((seed >> 8) & 0xFFFFFF) / (double) 0x1000000;
+}
+
+static int checked, failed;
+
+static void checkRanges(TimeSeriesPlot& plot, int ranges)
+{
+    if (plot.GetCount() == 0)
+        return;
+    double first = plot.GetTime(0), last = plot.GetTime(plot.GetCount() - 1);
+    for (int r = 0; r < ranges; r++)
+    {
+        // Mostly ranges within the samples, some reaching past either end, and some exactly on a sample's time
+        double from = randomBetween(first - 1, last + 1), to = randomBetween(from, last + 1);
+        if (r % 4 == 0)
+            from = plot.GetTime((int) randomBetween(0, plot.GetCount()));
+        if (r % 8 == 0)
+            to = from;
+
+        bool expectedFound = false;
+        double expectedMin = 0, expectedMax = 0;
+        for (int i = 0; i < plot.GetCount(); i++)
+        {
+            if (plot.GetTime(i) < from || plot.GetTime(i) > to)
+                continue;
+            double value = plot.GetValue(i);
+            expectedMin = expectedFound ? min(expectedMin, value) : value;
+            expectedMax = expectedFound ? max(expectedMax, value) : value;
+            expectedFound = true;
+        }
+
+        double minValue = 0, maxValue = 0;
+        bool found = plot.GetRange(from, to, minValue, maxValue);
+        checked++;
+        if (found != expectedFound || (found && (minValue != expectedMin || maxValue != expectedMax)))
+        {
+            if (failed++ < 10)
+                fprintf(stderr, "With %d samples, GetRange(%.17g, %.17g) gave %d %g..%g instead of %d %g..%g\n",
+                    plot.GetCount(), from, to, found, minValue, maxValue, expectedFound, expectedMin, expectedMax);
+        }
+    }
+}
+
+// Adds "count" samples at random intervals, some of them zero, with random values
+static void addSamples(TimeSeriesPlot& plot, double& time, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        time += randomBetween(0, 1) < 0.1 ? 0 : randomBetween(0, 2);
+        plot.Add(time, randomBetween(-1000, 1000));
+    }
+}
+
+int main()
+{
+    double time = 0;
+
+    // Unbounded, checked at sizes around and between the powers of two that complete pyramid levels
+    TimeSeriesPlot unbounded;
+    int sizes[] = { 1, 2, 3, 7, 8, 9, 100, 255, 256, 257, 1000, 4096, 5000 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        addSamples(unbounded, time, sizes[i] - unbounded.GetCount());
+        checkRanges(unbounded, 100);
+    }
+
+    // With a capacity, so that the oldest quarter is discarded again and again
+    TimeSeriesPlot bounded(1000);
+    for (int i = 0; i < 20; i++)
+    {
+        addSamples(bounded, time, 137);
+        if (bounded.GetCount() > 1000)
+        {
+            fprintf(stderr, "The plot holds %d samples, more than its capacity of 1000\n", bounded.GetCount());
+            failed++;
+        }
+        checkRanges(bounded, 50);
+    }
+
+    // Removing from the front, by times between and exactly on samples
+    for (int i = 0; i < 20 && unbounded.GetCount() > 0; i++)
+    {
+        double cut = i % 2 == 0 ? unbounded.GetTime(unbounded.GetCount() / 10) : randomBetween(unbounded.GetTime(0), time);
+        unbounded.RemoveBefore(cut);
+        if (unbounded.GetCount() > 0 && unbounded.GetTime(0) < cut)
+        {
+            fprintf(stderr, "RemoveBefore(%.17g) left a sample at %.17g\n", cut, unbounded.GetTime(0));
+            failed++;
+        }
+        checkRanges(unbounded, 50);
+        addSamples(unbounded, time, 100);
+        checkRanges(unbounded, 50);
+    }
+
+    printf("%d ranges checked, %d failures\n", checked, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+// Stand-ins for the Win32 threading calls used by WorkerPool, built on the C++11 thread library, for the headless build
+// (see PrecompiledBoostOrbiter.h). Only what WorkerPool needs is provided: critical sections are recursive as in Win32,
+// events are always manual-reset, and handles are only ever waited on with INFINITE.
+
+#include <limits.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#define __stdcall
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+#define INFINITE 0xFFFFFFFF
+
+typedef int BOOL;
+typedef long LONG;
+
+namespace headless {
+
+    class waitable : private boost::noncopyable
+    {
+    public:
+        virtual ~waitable() { }
+        virtual void Wait() = 0;
+    };
+
+    class semaphore : public waitable
+    {
+    public:
+        semaphore(LONG count) : _count(count) { }
+
+        virtual void Wait()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (_count == 0)
+                _changed.wait(lock);
+            _count--;
+        }
+
+        void Release(LONG count)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _count += count;
+            }
+            _changed.notify_all();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        LONG _count;
+    };
+
+    class event : public waitable
+    {
+    public:
+        event(bool set) : _set(set) { }
+
+        virtual void Wait()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_set)
+                _changed.wait(lock);
+        }
+
+        void Set()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _set = true;
+            }
+            _changed.notify_all();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        bool _set;
+    };
+
+    class thread : public waitable
+    {
+    public:
+        thread(unsigned (__stdcall* start)(void*), void* param) : _thread(start, param) { }
+        virtual ~thread() { if (_thread.joinable()) _thread.detach(); }
+        virtual void Wait() { if (_thread.joinable()) _thread.join(); }
+
+    private:
+        std::thread _thread;
+    };
+
+}
+
+typedef headless::waitable* HANDLE;
+
+struct CRITICAL_SECTION
+{
+    std::recursive_mutex Mutex;
+};
+
+inline void InitializeCriticalSection(CRITICAL_SECTION*) { }
+inline void DeleteCriticalSection(CRITICAL_SECTION*) { }
+inline void EnterCriticalSection(CRITICAL_SECTION* section) { section->Mutex.lock(); }
+inline void LeaveCriticalSection(CRITICAL_SECTION* section) { section->Mutex.unlock(); }
+
+#ifdef _MSC_VER
+inline LONG InterlockedExchange(volatile LONG* target, LONG value) { return _InterlockedExchange(target, value); }
+inline LONG InterlockedIncrement(volatile LONG* target) { return _InterlockedIncrement(target); }
+inline LONG InterlockedDecrement(volatile LONG* target) { return _InterlockedDecrement(target); }
+#else
+inline LONG InterlockedExchange(volatile LONG* target, LONG value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedIncrement(volatile LONG* target) { return __atomic_add_fetch(target, 1, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedDecrement(volatile LONG* target) { return __atomic_sub_fetch(target, 1, __ATOMIC_SEQ_CST); }
+#endif
+
+inline HANDLE CreateSemaphore(void*, LONG initialCount, LONG, const char*) { return new headless::semaphore(initialCount); }
+inline BOOL ReleaseSemaphore(HANDLE semaphore, LONG count, LONG*) { static_cast<headless::semaphore*>(semaphore)->Release(count); return TRUE; }
+inline HANDLE CreateEvent(void*, BOOL, BOOL initialState, const char*) { return new headless::event(initialState != FALSE); }
+inline BOOL SetEvent(HANDLE event) { static_cast<headless::event*>(event)->Set(); return TRUE; }
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD) { handle->Wait(); return 0; }
+inline BOOL CloseHandle(HANDLE handle) { delete handle; return TRUE; }
+
+inline uintptr_t _beginthreadex(void*, unsigned, unsigned (__stdcall* start)(void*), void* param, unsigned, unsigned*)
+{
+    return (uintptr_t) static_cast<HANDLE>(new headless::thread(start, param));
+}
+
+inline DWORD GetCurrentThreadId()
+{
+    return (DWORD) std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+struct SYSTEM_INFO
+{
+    DWORD dwNumberOfProcessors;
+};
+
+inline void GetSystemInfo(SYSTEM_INFO* info)
+{
+    info->dwNumberOfProcessors = std::max(1u, std::thread::hardware_concurrency());
+}
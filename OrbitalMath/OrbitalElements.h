@@ -0,0 +1,265 @@
+﻿//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+#include <OrbitalMath/OrbitalMath.h>
+
+namespace OrbitalMath {
+
+    // Describes a single orbit and the position of a body on it. Every derived quantity is computed on first use
+    // and then cached until the orbit is modified, so it's cheap to query the same quantity many times per frame.
+    // The getters are named after the quantities listed in OrbitalMath.h and return the same values as the
+    // corresponding OrbitalFunc functions.
+    class OrbitalElements
+    {
+    public:
+        OrbitalElements(const OrbitalState_Compat& state) { Set(state); }
+        OrbitalElements(const OrbitalState_Nat& state) { Set(state); }
+
+        // Replaces the orbit, discarding all cached quantities.
+        void Set(const OrbitalState_Compat& state)
+        {
+            _valid = 0;
+            store(FieldSemiMajorAxis, state.SemiMajorAxis);
+            store(FieldEccentricity, state.Eccentricity);
+            store(FieldInclination, state.Inclination);
+            store(FieldLonAscendingNode, state.LonAscendingNode);
+            store(FieldLonPeriapsis, state.LonPeriapsis);
+            store(FieldMeanLonAtEpoch, state.MeanLonAtEpoch);
+            store(FieldStdGravParam, state.StdGravParam);
+            store(FieldTrueAnomaly, state.TrueAnomaly);
+        }
+
+        // Replaces the orbit, discarding all cached quantities.
+        void Set(const OrbitalState_Nat& state)
+        {
+            _valid = 0;
+            store(FieldSemiLatusRectum, state.SemiLatusRectum);
+            store(FieldEccentricity, state.Eccentricity);
+            store(FieldInclination, state.Inclination);
+            store(FieldLonAscendingNode, state.LonAscendingNode);
+            store(FieldArgPeriapsis, state.ArgPeriapsis);
+            store(FieldSpecRelAngMomentum, state.SpecRelAngMomentum);
+            store(FieldTrueAnomaly, state.TrueAnomaly);
+        }
+
+        // Moves the body to a different point on the same orbit. Only the quantities that depend on the position
+        // of the body are discarded; the shape and orientation of the orbit remain cached.
+        void SetTrueAnomaly(double trueAnomaly)
+        {
+            _valid &= ~positionDependentFields();
+            store(FieldTrueAnomaly, trueAnomaly);
+        }
+
+        // Moves the body to the point on the same orbit that has the specified mean anomaly.
+        void SetMeanAnomaly(double meanAnomaly)
+        {
+            SetTrueAnomaly(OrbitalFunc::TrueAnomaly2(Eccentricity(), meanAnomaly));
+            store(FieldMeanAnomaly, meanAnomaly);
+        }
+
+        void GetCompat(OrbitalState_Compat* dest)
+        {
+            dest->SemiMajorAxis = SemiMajorAxis();
+            dest->Eccentricity = Eccentricity();
+            dest->Inclination = Inclination();
+            dest->LonAscendingNode = LonAscendingNode();
+            dest->LonPeriapsis = LonPeriapsis();
+            dest->MeanLonAtEpoch = MeanLonAtEpoch();
+            dest->StdGravParam = StdGravParam();
+            dest->TrueAnomaly = TrueAnomaly();
+        }
+
+        void GetNat(OrbitalState_Nat* dest)
+        {
+            dest->SemiLatusRectum = SemiLatusRectum();
+            dest->Eccentricity = Eccentricity();
+            dest->Inclination = Inclination();
+            dest->LonAscendingNode = LonAscendingNode();
+            dest->ArgPeriapsis = ArgPeriapsis();
+            dest->SpecRelAngMomentum = SpecRelAngMomentum();
+            dest->TrueAnomaly = TrueAnomaly();
+        }
+
+        // Shape, size and orientation of the orbit
+
+        double Eccentricity() { return _values[FieldEccentricity]; }
+        double Inclination() { return _values[FieldInclination]; }
+        double LonAscendingNode() { return _values[FieldLonAscendingNode]; }
+
+        double SemiMajorAxis()
+        {
+            if (!has(FieldSemiMajorAxis))
+                store(FieldSemiMajorAxis, OrbitalFunc::SemiMajorAxis3(Eccentricity(), SemiLatusRectum()));
+            return _values[FieldSemiMajorAxis];
+        }
+
+        double SemiLatusRectum()
+        {
+            if (!has(FieldSemiLatusRectum))
+                store(FieldSemiLatusRectum, OrbitalFunc::SemiLatusRectum3(Eccentricity(), SemiMajorAxis()));
+            return _values[FieldSemiLatusRectum];
+        }
+
+        double StdGravParam()
+        {
+            if (!has(FieldStdGravParam))
+                store(FieldStdGravParam, OrbitalFunc::StdGravParam2(SemiLatusRectum(), SpecRelAngMomentum()));
+            return _values[FieldStdGravParam];
+        }
+
+        double SpecRelAngMomentum()
+        {
+            if (!has(FieldSpecRelAngMomentum))
+                store(FieldSpecRelAngMomentum, OrbitalFunc::SpecRelAngMomentum2(SemiLatusRectum(), StdGravParam()));
+            return _values[FieldSpecRelAngMomentum];
+        }
+
+        double SpecOrbitalEnergy()
+        {
+            if (!has(FieldSpecOrbitalEnergy))
+                store(FieldSpecOrbitalEnergy, OrbitalFunc::SpecOrbitalEnergy1(SemiMajorAxis(), StdGravParam()));
+            return _values[FieldSpecOrbitalEnergy];
+        }
+
+        double Period()
+        {
+            if (!has(FieldPeriod))
+                store(FieldPeriod, OrbitalFunc::Period1(SemiMajorAxis(), StdGravParam()));
+            return _values[FieldPeriod];
+        }
+
+        double ArgPeriapsis()
+        {
+            if (!has(FieldArgPeriapsis))
+                store(FieldArgPeriapsis, OrbitalFunc::ArgPeriapsis1(LonPeriapsis(), LonAscendingNode()));
+            return _values[FieldArgPeriapsis];
+        }
+
+        double LonPeriapsis()
+        {
+            if (!has(FieldLonPeriapsis))
+                store(FieldLonPeriapsis, OrbitalFunc::LonPeriapsis1(ArgPeriapsis(), LonAscendingNode()));
+            return _values[FieldLonPeriapsis];
+        }
+
+        double DistanceAtPeriapsis()
+        {
+            if (!has(FieldDistanceAtPeriapsis))
+                store(FieldDistanceAtPeriapsis, OrbitalFunc::DistanceAtPeriapsis1(SemiLatusRectum(), Eccentricity()));
+            return _values[FieldDistanceAtPeriapsis];
+        }
+
+        double DistanceAtApoapsis()
+        {
+            if (!has(FieldDistanceAtApoapsis))
+                store(FieldDistanceAtApoapsis, OrbitalFunc::DistanceAtApoapsis1(Eccentricity(), SemiLatusRectum()));
+            return _values[FieldDistanceAtApoapsis];
+        }
+
+        double SpeedAtPeriapsis()
+        {
+            if (!has(FieldSpeedAtPeriapsis))
+                store(FieldSpeedAtPeriapsis, OrbitalFunc::SpeedAtPeriapsis1(Eccentricity(), SemiLatusRectum(), StdGravParam()));
+            return _values[FieldSpeedAtPeriapsis];
+        }
+
+        double SpeedAtApoapsis()
+        {
+            if (!has(FieldSpeedAtApoapsis))
+                store(FieldSpeedAtApoapsis, OrbitalFunc::SpeedAtApoapsis1(Eccentricity(), SemiLatusRectum(), StdGravParam()));
+            return _values[FieldSpeedAtApoapsis];
+        }
+
+        // Position of the body on the orbit
+
+        double TrueAnomaly() { return _values[FieldTrueAnomaly]; }
+
+        double EccentricAnomaly()
+        {
+            if (!has(FieldEccentricAnomaly))
+                store(FieldEccentricAnomaly, OrbitalFunc::EccentricAnomaly2(Eccentricity(), TrueAnomaly()));
+            return _values[FieldEccentricAnomaly];
+        }
+
+        double MeanAnomaly()
+        {
+            if (!has(FieldMeanAnomaly))
+                store(FieldMeanAnomaly, OrbitalFunc::MeanAnomaly2(Eccentricity(), EccentricAnomaly()));
+            return _values[FieldMeanAnomaly];
+        }
+
+        double MeanLonAtEpoch()
+        {
+            if (!has(FieldMeanLonAtEpoch))
+                store(FieldMeanLonAtEpoch, OrbitalFunc::MeanLonAtEpoch3(MeanAnomaly(), LonPeriapsis()));
+            return _values[FieldMeanLonAtEpoch];
+        }
+
+        double TimeOfPeriapsisPassage()
+        {
+            if (!has(FieldTimeOfPeriapsisPassage))
+                store(FieldTimeOfPeriapsisPassage, OrbitalFunc::TimeOfPeriapsisPassage1(Period(), MeanAnomaly()));
+            return _values[FieldTimeOfPeriapsisPassage];
+        }
+
+        double Distance()
+        {
+            if (!has(FieldDistance))
+                store(FieldDistance, OrbitalFunc::Distance1(Eccentricity(), SemiLatusRectum(), TrueAnomaly()));
+            return _values[FieldDistance];
+        }
+
+        double Speed()
+        {
+            if (!has(FieldSpeed))
+                store(FieldSpeed, OrbitalFunc::Speed5(SemiMajorAxis(), StdGravParam(), Distance()));
+            return _values[FieldSpeed];
+        }
+
+    private:
+        enum Field
+        {
+            FieldEccentricity,
+            FieldInclination,
+            FieldLonAscendingNode,
+            FieldSemiMajorAxis,
+            FieldSemiLatusRectum,
+            FieldStdGravParam,
+            FieldSpecRelAngMomentum,
+            FieldSpecOrbitalEnergy,
+            FieldPeriod,
+            FieldArgPeriapsis,
+            FieldLonPeriapsis,
+            FieldDistanceAtPeriapsis,
+            FieldDistanceAtApoapsis,
+            FieldSpeedAtPeriapsis,
+            FieldSpeedAtApoapsis,
+            FieldTrueAnomaly,
+            FieldEccentricAnomaly,
+            FieldMeanAnomaly,
+            FieldMeanLonAtEpoch,
+            FieldTimeOfPeriapsisPassage,
+            FieldDistance,
+            FieldSpeed,
+            FieldCount
+        };
+
+        double _values[FieldCount];
+        unsigned int _valid; // bit N set means _values[N] is up-to-date
+
+        inline bool has(Field field) { return (_valid & (1u << field)) != 0; }
+        inline void store(Field field, double value) { _values[field] = value; _valid |= 1u << field; }
+
+        static unsigned int positionDependentFields()
+        {
+            return (1u << FieldTrueAnomaly) | (1u << FieldEccentricAnomaly) | (1u << FieldMeanAnomaly) | (1u << FieldMeanLonAtEpoch)
+                | (1u << FieldTimeOfPeriapsisPassage) | (1u << FieldDistance) | (1u << FieldSpeed);
+        }
+    };
+
+}
@@ -129,4 +129,110 @@ namespace OrbitalMath { namespace OrbitalFunc {
         return acos( (Eccentricity - cosine) / (Eccentricity * cosine - 1) );
     }
 
+    // Computes the [true anomaly] of a body in an elliptic orbit directly from its mean anomaly. Eccentricity must be less than 1.
+    // The result is in the range -PI..PI and is on the correct half of the orbit, unlike with TrueAnomaly1.
+    inline double TrueAnomalyElliptic2(double Eccentricity, double MeanAnomaly)
+    {
+        if (Eccentricity >= 1)
+            return std::numeric_limits<double>::quiet_NaN();
+        // Solve Kepler's equation for the mean anomaly wrapped into -PI..PI. Newton-Raphson converges from these starting
+        // points for every eccentricity below 1 (the second one is Danby's), so no bisection fallback is needed.
+        double M = MeanAnomaly - 2*PI * floor((MeanAnomaly + PI) / (2*PI));
+        double E = Eccentricity < 0.8 ? M + Eccentricity * sin(M) : M + 0.85 * Eccentricity * (M < 0 ? -1 : 1);
+        double sinE = 0, cosE = 1;
+        for (int iter = 0; iter < 50; iter++)
+        {
+            sinE = sin(E);
+            cosE = cos(E);
+            double step = (E - Eccentricity * sinE - M)  /  (1 - Eccentricity * cosE);
+            E -= step;
+            if (abs(step) < 1e-8) // convergence is quadratic, so the remaining error is already negligible
+            {
+                // Bring sin/cos up to date with the final correction instead of calling sin/cos again (the step is tiny)
+                double sinNew = sinE - cosE * step;
+                cosE = cosE + sinE * step;
+                sinE = sinNew;
+                break;
+            }
+        }
+        return atan2(sqrt(1 - Eccentricity * Eccentricity) * sinE, cosE - Eccentricity);
+    }
+
+    // Computes the [true anomaly] of a body in a hyperbolic orbit directly from its mean anomaly. Eccentricity must be greater than 1.
+    // The result has the same sign as the mean anomaly.
+    inline double TrueAnomalyHyperbolic2(double Eccentricity, double MeanAnomaly)
+    {
+        if (Eccentricity < 1)
+            return std::numeric_limits<double>::quiet_NaN();
+        // Solve: MeanAnomaly = Eccentricity * sinh(EccentricAnomaly) - EccentricAnomaly
+        double H = MeanAnomaly == 0 ? 0 : (MeanAnomaly < 0 ? -1 : 1) * log(2 * abs(MeanAnomaly) / Eccentricity + 1.8);
+        double sinhH = 0, coshH = 1;
+        for (int iter = 0; iter < 50; iter++)
+        {
+            double expH = exp(H); // one exp gives both sinh and cosh
+            sinhH = (expH - 1 / expH) / 2;
+            coshH = (expH + 1 / expH) / 2;
+            double step = (Eccentricity * sinhH - H - MeanAnomaly)  /  (Eccentricity * coshH - 1);
+            H -= step;
+            if (abs(step) < 1e-8) // convergence is quadratic, so the remaining error is already negligible
+            {
+                double sinhNew = sinhH - coshH * step;
+                coshH = coshH - sinhH * step;
+                sinhH = sinhNew;
+                break;
+            }
+        }
+        return atan2(sqrt(Eccentricity * Eccentricity - 1) * sinhH, Eccentricity - coshH);
+    }
+
+    // Computes the [true anomaly] of a body in orbit directly from its mean anomaly. Equivalent to chaining EccentricAnomaly1
+    // and TrueAnomaly1, but reuses the trigonometric values from the final Kepler equation iteration and returns the
+    // correct quadrant.
+    inline double TrueAnomaly2(double Eccentricity, double MeanAnomaly)
+    {
+        if (Eccentricity < 1)
+            return TrueAnomalyElliptic2(Eccentricity, MeanAnomaly);
+        else
+            return TrueAnomalyHyperbolic2(Eccentricity, MeanAnomaly);
+    }
+
+    // Computes the [true anomaly] for "count" mean anomalies of bodies in the same orbit.
+    inline void TrueAnomaly2(double Eccentricity, const double* MeanAnomaly, double* TrueAnomaly, int count)
+    {
+        if (Eccentricity < 1)
+            for (int i = 0; i < count; i++)
+                TrueAnomaly[i] = TrueAnomalyElliptic2(Eccentricity, MeanAnomaly[i]);
+        else
+            for (int i = 0; i < count; i++)
+                TrueAnomaly[i] = TrueAnomalyHyperbolic2(Eccentricity, MeanAnomaly[i]);
+    }
+
+    // Computes the [mean anomaly] of a body in orbit directly from its true anomaly, without going through the
+    // tangent of the half-angle (so it is well-behaved over the whole orbit). The result is in the range -PI..PI
+    // for elliptic orbits.
+    inline double MeanAnomaly4(double Eccentricity, double TrueAnomaly)
+    {
+        double sinV = sin(TrueAnomaly);
+        double cosV = cos(TrueAnomaly);
+        double denom = 1 + Eccentricity * cosV;
+        if (Eccentricity < 1)
+        {
+            double sinE = sqrt(1 - Eccentricity * Eccentricity) * sinV / denom;
+            double cosE = (Eccentricity + cosV) / denom;
+            return atan2(sinE, cosE) - Eccentricity * sinE;
+        }
+        else
+        {
+            double sinhH = sqrt(Eccentricity * Eccentricity - 1) * sinV / denom;
+            return Eccentricity * sinhH - asinh(sinhH);
+        }
+    }
+
+    // Computes the [mean anomaly] for "count" true anomalies of bodies in the same orbit.
+    inline void MeanAnomaly4(double Eccentricity, const double* TrueAnomaly, double* MeanAnomaly, int count)
+    {
+        for (int i = 0; i < count; i++)
+            MeanAnomaly[i] = MeanAnomaly4(Eccentricity, TrueAnomaly[i]);
+    }
+
 }}
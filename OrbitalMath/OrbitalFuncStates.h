@@ -50,7 +50,7 @@ namespace OrbitalMath { namespace OrbitalFunc {
 
         dest->SemiMajorAxis = SemiMajorAxis3(src.Eccentricity, src.SemiLatusRectum);
         dest->LonPeriapsis = LonPeriapsis1(src.ArgPeriapsis, src.LonAscendingNode);
-        dest->MeanLonAtEpoch = MeanLonAtEpoch0(MeanAnomaly, dest->LonPeriapsis);
+        dest->MeanLonAtEpoch = MeanLonAtEpoch3(MeanAnomaly, dest->LonPeriapsis);
         dest->StdGravParam = StdGravParam2(src.SemiLatusRectum, src.SpecRelAngMomentum);
     }
 
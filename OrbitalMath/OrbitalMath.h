@@ -12,6 +12,7 @@
 #include "OrbitalFuncAux.h"
 #include "OrbitalFuncAnomaly.h"
 #include "OrbitalFuncStates.h"
+#include "OrbitalElements.h"
 
 #if 0
 
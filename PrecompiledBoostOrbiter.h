@@ -5,6 +5,43 @@
 //----------------------------------------------------------------------------
 #pragma once
 
+#ifdef BORB_SOFTWARE_SKETCHPAD
+
+// The headless build (see Headless/CMakeLists.txt) compiles only the drawing code, on the software Sketchpad, and the
+// WorkerPool. It needs neither Windows nor the Orbiter SDK: just the standard headers and the few Windows types, macros
+// and threading calls the code uses, so that it builds with any C++11 compiler.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+typedef uint32_t DWORD;
+
+#include <Headless/Win32Threading.h>
+
+namespace borb {
+    // windows.h defines these as macros
+    using std::min;
+    using std::max;
+}
+
+#else
+
 #define WIN32_LEAN_AND_MEAN
 #define NOSERVICE
 #define NOMCX
@@ -30,6 +67,11 @@
 #include <deque>
 #include <sstream>
 #include <iomanip>
+#include <functional>
+#include <stdexcept>
 
 #include <boost/ptr_container/ptr_container.hpp>
+#include <boost/circular_buffer.hpp>
 #include <boost/filesystem.hpp>
+
+#endif
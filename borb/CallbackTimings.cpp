@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "CallbackTimings.h"
+
+namespace borb {
+
+    using namespace std;
+
+    const char* GetModuleCallbackName(ModuleCallback callback)
+    {
+        switch (callback)
+        {
+            case ModuleCallbackOpenRenderViewport: return "opcOpenRenderViewport";
+            case ModuleCallbackCloseRenderViewport: return "opcCloseRenderViewport";
+            case ModuleCallbackLoadState: return "opcLoadState";
+            case ModuleCallbackSaveState: return "opcSaveState";
+            case ModuleCallbackPreStep: return "opcPreStep";
+            case ModuleCallbackPostStep: return "opcPostStep";
+            case ModuleCallbackDeleteVessel: return "opcDeleteVessel";
+        }
+        return "?";
+    }
+
+
+
+    int DurationHistogram::bucketIndex(double microseconds)
+    {
+        if (microseconds < subBuckets)
+            return microseconds < 0 ? 0 : (int) microseconds;
+        int exponent;
+        double mantissa = frexp(microseconds, &exponent); // microseconds = mantissa * 2^exponent, mantissa in [0.5, 1)
+        int index = subBuckets * (exponent - 4) + (int) (mantissa * 2 * subBuckets) - subBuckets;
+        return min(index, (int) bucketCount - 1);
+    }
+
+    double DurationHistogram::bucketValue(int index)
+    {
+        if (index < subBuckets)
+            return index + 0.5;
+        int exponent = index / subBuckets + 4;
+        double width = ldexp(1.0, exponent - 5);
+        return (subBuckets + index % subBuckets + 0.5) * width;
+    }
+
+    void DurationHistogram::Record(double microseconds)
+    {
+        _buckets[bucketIndex(microseconds)]++;
+        _count++;
+        _total += microseconds;
+        if (microseconds > _max)
+            _max = microseconds;
+    }
+
+    void DurationHistogram::Reset()
+    {
+        memset(_buckets, 0, sizeof(_buckets));
+        _count = 0;
+        _total = _max = 0;
+    }
+
+    double DurationHistogram::GetPercentile(double fraction)
+    {
+        if (_count == 0)
+            return 0;
+        long long target = (long long) ceil(clamp(fraction, 0.0, 1.0) * _count);
+        long long seen = 0;
+        for (int i = 0; i < bucketCount; i++)
+        {
+            seen += _buckets[i];
+            if (seen >= target && seen > 0)
+                return min(bucketValue(i), _max);
+        }
+        return _max;
+    }
+
+
+
+    CallbackTimings::CallbackTimings(const string& moduleName, double budgetMicroseconds, double summaryIntervalSeconds)
+    {
+        _moduleName = moduleName;
+        _budgetMicroseconds = budgetMicroseconds;
+        _summaryIntervalSeconds = summaryIntervalSeconds;
+        _lastSummaryTicks = GetPreciseTicks();
+        memset(_overBudget, 0, sizeof(_overBudget));
+    }
+
+    void CallbackTimings::Record(ModuleCallback callback, double microseconds)
+    {
+        _histograms[callback].Record(microseconds);
+
+        if (microseconds > _budgetMicroseconds)
+        {
+            // Only the first occurrence per summary interval is logged, to avoid flooding the log every frame;
+            // the rest are counted in the summary.
+            if (_overBudget[callback] == 0)
+            {
+                ostringstream msg;
+                msg << "Module " << _moduleName << ": " << GetModuleCallbackName(callback) << " took " << fixed << setprecision(0)
+                    << microseconds << " us, exceeding the budget of " << _budgetMicroseconds << " us.";
+                WriteLog(msg.str());
+            }
+            _overBudget[callback]++;
+        }
+
+        if (callback == ModuleCallbackPreStep && PreciseTicksToSeconds(GetPreciseTicks() - _lastSummaryTicks) >= _summaryIntervalSeconds)
+            LogSummary();
+    }
+
+    void CallbackTimings::LogSummary()
+    {
+        double seconds = PreciseTicksToSeconds(GetPreciseTicks() - _lastSummaryTicks);
+        _lastSummaryTicks = GetPreciseTicks();
+
+        for (int i = 0; i < ModuleCallbackCount; i++)
+        {
+            DurationHistogram& hist = _histograms[i];
+            if (hist.GetCount() == 0)
+                continue;
+            ostringstream msg;
+            msg << "Module " << _moduleName << ": " << GetModuleCallbackName((ModuleCallback) i) << " timings over the last "
+                << fixed << setprecision(0) << seconds << " s: count=" << hist.GetCount()
+                << setprecision(1) << ", mean=" << hist.GetMean() << " us, p50=" << hist.GetPercentile(0.5)
+                << " us, p99=" << hist.GetPercentile(0.99) << " us, max=" << hist.GetMax() << " us, over budget=" << _overBudget[i];
+            WriteLog(msg.str());
+            hist.Reset();
+            _overBudget[i] = 0;
+        }
+    }
+
+}
@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "Misc.h"
+
+namespace borb {
+
+    // The Orbiter callbacks dispatched by Module.cpp.h.
+    enum ModuleCallback
+    {
+        ModuleCallbackOpenRenderViewport,
+        ModuleCallbackCloseRenderViewport,
+        ModuleCallbackLoadState,
+        ModuleCallbackSaveState,
+        ModuleCallbackPreStep,
+        ModuleCallbackPostStep,
+        ModuleCallbackDeleteVessel,
+        ModuleCallbackCount
+    };
+
+    // Returns the name of the Orbiter callback, e.g. "opcPreStep".
+    const char* GetModuleCallbackName(ModuleCallback callback);
+
+    // A histogram of durations in the style of HdrHistogram. Durations below 16 microseconds get a bucket per
+    // microsecond; above that, every power of two is split into 16 equal buckets, so any duration up to about an
+    // hour and a quarter is reported to within ~6% of its true value. Recording is O(1) and never allocates.
+    class DurationHistogram
+    {
+    public:
+        DurationHistogram() { Reset(); }
+
+        void Record(double microseconds);
+        void Reset();
+
+        long long GetCount() { return _count; }
+        double GetMean() { return _count == 0 ? 0 : _total / _count; }
+        double GetMax() { return _max; }
+        // Returns the duration (in microseconds) which the specified fraction (0..1) of the recorded durations don't exceed.
+        double GetPercentile(double fraction);
+
+    private:
+        enum { subBuckets = 16, bucketCount = 16 * 29 };
+
+        long long _buckets[bucketCount];
+        long long _count;
+        double _total, _max;
+
+        static int bucketIndex(double microseconds);
+        static double bucketValue(int index);
+    };
+
+    // Keeps a DurationHistogram for each module callback. Writes a summary to the Orbiter log at regular intervals,
+    // and a warning when a callback takes longer than the frame budget. Used by Module.cpp.h when BORB_MODULE_TIMING
+    // is defined.
+    class CallbackTimings : private boost::noncopyable
+    {
+    public:
+        CallbackTimings(const std::string& moduleName, double budgetMicroseconds, double summaryIntervalSeconds);
+
+        void Record(ModuleCallback callback, double microseconds);
+        // Writes the statistics for every callback invoked since the previous summary to the log, then resets them.
+        void LogSummary();
+
+    private:
+        std::string _moduleName;
+        double _budgetMicroseconds, _summaryIntervalSeconds;
+        long long _lastSummaryTicks;
+        DurationHistogram _histograms[ModuleCallbackCount];
+        int _overBudget[ModuleCallbackCount];
+    };
+
+    // Measures the time between its construction and destruction, and records it in a CallbackTimings.
+    class CallbackTimer : private boost::noncopyable
+    {
+    public:
+        CallbackTimer(CallbackTimings& timings, ModuleCallback callback)
+            : _timings(timings), _callback(callback), _start(GetPreciseTicks())
+        {
+        }
+
+        ~CallbackTimer()
+        {
+            _timings.Record(_callback, PreciseTicksToSeconds(GetPreciseTicks() - _start) * 1e6);
+        }
+
+    private:
+        CallbackTimings& _timings;
+        ModuleCallback _callback;
+        long long _start;
+    };
+
+}
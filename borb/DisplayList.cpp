@@ -0,0 +1,57 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "DisplayList.h"
+
+namespace borb {
+
+    using namespace std;
+
+    void DisplayList::Clear()
+    {
+        _valid = false;
+        vector<DisplayCommand>().swap(_commands);
+        vector<IVECTOR2>().swap(_points);
+        string().swap(_text);
+    }
+
+    bool DisplayList::isCurrent(size_t hash, int dispSize, double originX, double originY, int generation)
+    {
+        return _valid && _hash == hash && _dispSize == dispSize && _originX == originX && _originY == originY && _generation == generation;
+    }
+
+    void DisplayList::begin(size_t hash, int dispSize, double originX, double originY, int generation)
+    {
+        // Keep the capacity: a re-recorded section is usually about the same size as before
+        _commands.clear();
+        _points.clear();
+        _text.clear();
+        _hash = hash;
+        _dispSize = dispSize;
+        _originX = originX;
+        _originY = originY;
+        _generation = generation;
+        _valid = false;
+    }
+
+    void DisplayList::add(const DisplayCommand& cmd, const IVECTOR2* points, const char* text)
+    {
+        _commands.push_back(cmd);
+        DisplayCommand& added = _commands.back();
+        if (points != NULL)
+        {
+            added.Data = (int) _points.size();
+            _points.insert(_points.end(), points, points + cmd.Count);
+        }
+        else if (text != NULL)
+        {
+            added.Data = (int) _text.size();
+            _text.append(text, cmd.Count);
+        }
+    }
+
+}
@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "SketchpadHelper.h"
+
+namespace borb {
+
+    enum DisplayOp
+    {
+        DisplayOpSetFont,
+        DisplayOpSetPen,
+        DisplayOpSetBrush,
+        DisplayOpSetTextColor,
+        DisplayOpSetTextBackColor,
+        DisplayOpSetTextBackTransparent,
+        DisplayOpMoveTo,
+        DisplayOpLineTo,
+        DisplayOpLine,
+        DisplayOpRectangle,
+        DisplayOpEllipse,
+        DisplayOpPolygon,
+        DisplayOpPolyline,
+        DisplayOpText,
+        DisplayOpTextBox,
+    };
+
+    // A single drawing operation, in pixel coordinates. Points and text are stored separately, in the DisplayList;
+    // Data is the offset of the first point or character there, and Count the number of them.
+    struct DisplayCommand
+    {
+        DisplayOp Op;
+        int Args[4]; // coordinates; for text lines, x, y, and the horizontal and vertical alignment
+        int Count, Data;
+        void* Resource; // the pen, brush or font to select, or NULL for none
+        DWORD Color;
+    };
+
+    // A recording of a section of an MFD page, made by SketchpadHelper::BeginSection and EndSection. While the content
+    // of the section stays the same, the helper replays the recorded Sketchpad calls instead of having the MFD format
+    // and draw it all again. The recording holds pixel coordinates, so it's redone whenever the MFD size or the
+    // helper's origin changes, and raw resource pointers, so it's redone whenever SketchpadResources is cleared.
+    // Any other resources used in a section must outlive the recording.
+    class DisplayList
+    {
+    public:
+        DisplayList() : _valid(false) { }
+
+        // Forces the section to be drawn and recorded again the next time it's begun.
+        void Invalidate() { _valid = false; }
+        bool IsValid() { return _valid; }
+        // Invalidates the list and releases its memory.
+        void Clear();
+
+    private:
+        friend class SketchpadHelper;
+
+        bool _valid;
+        size_t _hash;
+        int _dispSize, _generation;
+        double _originX, _originY;
+        std::vector<DisplayCommand> _commands;
+        std::vector<IVECTOR2> _points;
+        std::string _text;
+
+        bool isCurrent(size_t hash, int dispSize, double originX, double originY, int generation);
+        void begin(size_t hash, int dispSize, double originX, double originY, int generation);
+        void add(const DisplayCommand& cmd, const IVECTOR2* points, const char* text);
+        const IVECTOR2* getPoints(const DisplayCommand& cmd) { return cmd.Op == DisplayOpPolygon || cmd.Op == DisplayOpPolyline ? _points.data() + cmd.Data : NULL; }
+        const char* getText(const DisplayCommand& cmd) { return cmd.Op == DisplayOpText || cmd.Op == DisplayOpTextBox ? _text.data() + cmd.Data : NULL; }
+    };
+
+}
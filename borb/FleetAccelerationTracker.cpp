@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "FleetAccelerationTracker.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace borb {
+
+    using namespace std;
+
+    int FleetAccelerationTracker::Find(VESSEL* vessel)
+    {
+        int* found = _index.Find(vessel);
+        return found == NULL ? -1 : *found;
+    }
+
+    // Brings the vessel list in line with Orbiter's, carrying each surviving vessel's last velocity over to its new index.
+    // A vessel is identified by its handle, interface pointer and name together: Orbiter can reuse the memory of a
+    // deleted vessel for a new one, and the new one must not inherit the old one's velocity.
+    void FleetAccelerationTracker::syncVessels()
+    {
+        DWORD count = oapiGetVesselCount();
+        bool changed = count != _vessels.size();
+        for (DWORD i = 0; !changed && i < count; i++)
+        {
+            OBJHANDLE handle = oapiGetVesselByIndex(i);
+            VESSEL* vessel = oapiGetVesselInterface(handle);
+            changed = handle != _handles[i] || vessel != _vessels[i] || _names[i] != vessel->GetName();
+        }
+        if (!changed)
+            return;
+
+        vector<VESSEL*> vessels(count);
+        vector<OBJHANDLE> handles(count);
+        vector<string> names(count);
+        Vector3Array lastVel;
+        lastVel.resize(count);
+        _newVessels.clear();
+        for (DWORD i = 0; i < count; i++)
+        {
+            handles[i] = oapiGetVesselByIndex(i);
+            vessels[i] = oapiGetVesselInterface(handles[i]);
+            names[i] = vessels[i]->GetName();
+            int old = Find(vessels[i]);
+            if (old >= 0 && _handles[old] == handles[i] && _names[old] == names[i])
+                lastVel.Set(i, _lastVel.Get(old));
+            else
+                _newVessels.push_back(i);
+        }
+
+        _vessels.swap(vessels);
+        _handles.swap(handles);
+        _names.swap(names);
+        _lastVel = lastVel;
+        _index.Clear();
+        for (DWORD i = 0; i < count; i++)
+            _index.Set(_vessels[i], i);
+
+        for (int k = 0; k < 9; k++)
+            _rot[k].resize(count);
+        _vel.resize(count);
+        _weight.resize(count);
+        _mass.resize(count);
+        TotalAccel.resize(count);
+        GravAccel.resize(count);
+        PerceivedAccel.resize(count);
+    }
+
+    void FleetAccelerationTracker::fetch()
+    {
+        MATRIX3 rot;
+        VECTOR3 vec;
+        for (size_t i = 0; i < _vessels.size(); i++)
+        {
+            VESSEL* vessel = _vessels[i];
+            vessel->GetRotationMatrix(rot);
+            for (int k = 0; k < 9; k++)
+                _rot[k][i] = rot.data[k];
+            vessel->GetWeightVector(vec);
+            _weight.Set(i, vec);
+            _mass[i] = vessel->GetMass();
+            vessel->GetGlobalVel(vec);
+            _vel.Set(i, vec);
+        }
+    }
+
+#if defined(_M_IX86) || defined(_M_X64)
+    // a1 * b1 + a2 * b2 + a3 * b3, for two values at once
+    static inline __m128d dot3(__m128d a1, __m128d b1, __m128d a2, __m128d b2, __m128d a3, __m128d b3)
+    {
+        return _mm_add_pd(_mm_add_pd(_mm_mul_pd(a1, b1), _mm_mul_pd(a2, b2)), _mm_mul_pd(a3, b3));
+    }
+#endif
+
+    void FleetAccelerationTracker::compute(double dt)
+    {
+        int n = (int) _vessels.size();
+        if (n == 0)
+            return;
+        const double *r11 = &_rot[0][0], *r12 = &_rot[1][0], *r13 = &_rot[2][0];
+        const double *r21 = &_rot[3][0], *r22 = &_rot[4][0], *r23 = &_rot[5][0];
+        const double *r31 = &_rot[6][0], *r32 = &_rot[7][0], *r33 = &_rot[8][0];
+        const double *wx = &_weight.X[0], *wy = &_weight.Y[0], *wz = &_weight.Z[0], *mass = &_mass[0];
+        const double *vx = &_vel.X[0], *vy = &_vel.Y[0], *vz = &_vel.Z[0];
+        const double *lx = &_lastVel.X[0], *ly = &_lastVel.Y[0], *lz = &_lastVel.Z[0];
+        double *gx = &GravAccel.X[0], *gy = &GravAccel.Y[0], *gz = &GravAccel.Z[0];
+        double *tx = &TotalAccel.X[0], *ty = &TotalAccel.Y[0], *tz = &TotalAccel.Z[0];
+        double *px = &PerceivedAccel.X[0], *py = &PerceivedAccel.Y[0], *pz = &PerceivedAccel.Z[0];
+        double invDt = 1 / dt;
+
+        // Each iteration computes, for one vessel: the gravitational acceleration (the weight rotated into the global
+        // frame, divided by mass), the true acceleration in the inertial frame, and the perceived acceleration (the
+        // non-gravitational part, rotated back into the local frame with the transposed matrix). The SSE2 loop does
+        // two vessels at a time, in the same order of operations as the scalar loop, which finishes off the remainder.
+        int i = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+        __m128d vInvDt = _mm_set1_pd(invDt), vOne = _mm_set1_pd(1);
+        for (; i + 2 <= n; i += 2)
+        {
+            __m128d m11 = _mm_loadu_pd(r11 + i), m12 = _mm_loadu_pd(r12 + i), m13 = _mm_loadu_pd(r13 + i);
+            __m128d m21 = _mm_loadu_pd(r21 + i), m22 = _mm_loadu_pd(r22 + i), m23 = _mm_loadu_pd(r23 + i);
+            __m128d m31 = _mm_loadu_pd(r31 + i), m32 = _mm_loadu_pd(r32 + i), m33 = _mm_loadu_pd(r33 + i);
+            __m128d invMass = _mm_div_pd(vOne, _mm_loadu_pd(mass + i));
+            __m128d x = _mm_loadu_pd(wx + i), y = _mm_loadu_pd(wy + i), z = _mm_loadu_pd(wz + i);
+            __m128d g1 = _mm_mul_pd(dot3(m11, x, m12, y, m13, z), invMass);
+            __m128d g2 = _mm_mul_pd(dot3(m21, x, m22, y, m23, z), invMass);
+            __m128d g3 = _mm_mul_pd(dot3(m31, x, m32, y, m33, z), invMass);
+            __m128d t1 = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(vx + i), _mm_loadu_pd(lx + i)), vInvDt);
+            __m128d t2 = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(vy + i), _mm_loadu_pd(ly + i)), vInvDt);
+            __m128d t3 = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(vz + i), _mm_loadu_pd(lz + i)), vInvDt);
+            _mm_storeu_pd(gx + i, g1);
+            _mm_storeu_pd(gy + i, g2);
+            _mm_storeu_pd(gz + i, g3);
+            _mm_storeu_pd(tx + i, t1);
+            _mm_storeu_pd(ty + i, t2);
+            _mm_storeu_pd(tz + i, t3);
+            x = _mm_sub_pd(t1, g1);
+            y = _mm_sub_pd(t2, g2);
+            z = _mm_sub_pd(t3, g3);
+            _mm_storeu_pd(px + i, dot3(m11, x, m21, y, m31, z));
+            _mm_storeu_pd(py + i, dot3(m12, x, m22, y, m32, z));
+            _mm_storeu_pd(pz + i, dot3(m13, x, m23, y, m33, z));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            double invMass = 1 / mass[i];
+            gx[i] = (r11[i] * wx[i] + r12[i] * wy[i] + r13[i] * wz[i]) * invMass;
+            gy[i] = (r21[i] * wx[i] + r22[i] * wy[i] + r23[i] * wz[i]) * invMass;
+            gz[i] = (r31[i] * wx[i] + r32[i] * wy[i] + r33[i] * wz[i]) * invMass;
+            tx[i] = (vx[i] - lx[i]) * invDt;
+            ty[i] = (vy[i] - ly[i]) * invDt;
+            tz[i] = (vz[i] - lz[i]) * invDt;
+            double dx = tx[i] - gx[i], dy = ty[i] - gy[i], dz = tz[i] - gz[i];
+            px[i] = r11[i] * dx + r21[i] * dy + r31[i] * dz;
+            py[i] = r12[i] * dx + r22[i] * dy + r32[i] * dz;
+            pz[i] = r13[i] * dx + r23[i] * dy + r33[i] * dz;
+        }
+    }
+
+    void FleetAccelerationTracker::PreStep()
+    {
+        // As in VesselAccelerationTracker, measure the interval rather than trusting simdt, do nothing while paused, and
+        // start over if the time went backwards (e.g. a scenario reload)
+        double simt = oapiGetSimTime();
+        double dt = simt - _simtLast;
+        if (!_first && dt < 0)
+            _first = true;
+        if (!_first && dt == 0)
+            return;
+
+        syncVessels();
+        fetch();
+        if (_first)
+        {
+            _first = false;
+            for (size_t i = 0; i < _vessels.size(); i++)
+                _newVessels.push_back((int) i);
+        }
+        else
+            compute(dt);
+
+        for (size_t k = 0; k < _newVessels.size(); k++)
+        {
+            int i = _newVessels[k];
+            TotalAccel.Set(i, _V(0, 0, 0));
+            GravAccel.Set(i, _V(0, 0, 0));
+            PerceivedAccel.Set(i, _V(0, 0, 0));
+        }
+        _newVessels.clear();
+
+        _lastVel.X.swap(_vel.X);
+        _lastVel.Y.swap(_vel.Y);
+        _lastVel.Z.swap(_vel.Z);
+        _simtLast = simt;
+    }
+
+}
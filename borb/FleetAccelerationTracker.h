@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "SlotMap.h"
+
+namespace borb {
+
+    // An array of vectors stored as three arrays of components, so that loops over many vectors vectorize.
+    struct Vector3Array
+    {
+        std::vector<double> X, Y, Z;
+
+        void resize(size_t size) { X.resize(size); Y.resize(size); Z.resize(size); }
+        VECTOR3 Get(size_t index) { return _V(X[index], Y[index], Z[index]); }
+        void Set(size_t index, const VECTOR3& value) { X[index] = value.x; Y[index] = value.y; Z[index] = value.z; }
+    };
+
+    // Calculates the same accelerations as VesselAccelerationTracker, but for every vessel in the simulation at once.
+    // PreStep first fetches the rotation matrix, weight, mass and velocity of every vessel in a single pass over the
+    // Orbiter API, into one array per component, then computes all the accelerations with a loop over those arrays
+    // that handles two vessels at a time using SSE2. The results are indexed the same way as oapiGetVesselByIndex.
+    class FleetAccelerationTracker
+    {
+    public:
+        FleetAccelerationTracker() : _first(true) { }
+
+        // Call this in every pre-step. Vessels that were created since the previous call read zero until the next one.
+        void PreStep();
+
+        int GetCount() { return (int) _vessels.size(); }
+        VESSEL* GetVessel(int index) { return _vessels[index]; }
+        // Returns the index of the vessel in the arrays below, or -1 if it wasn't there at the last PreStep.
+        int Find(VESSEL* vessel);
+
+        // As in VesselAccelerationTracker: the true and gravitational accelerations in the global frame, and the
+        // perceived acceleration in the vessel's local coordinate system.
+        Vector3Array TotalAccel, GravAccel, PerceivedAccel;
+
+    private:
+        bool _first;
+        double _simtLast;
+        std::vector<VESSEL*> _vessels;
+        std::vector<OBJHANDLE> _handles; // of each vessel in _vessels, to tell a new vessel from an old one at the same address
+        std::vector<std::string> _names; // likewise
+        FlatPointerMap<VESSEL, int> _index;
+        std::vector<int> _newVessels; // indices of the vessels with no previous velocity yet
+
+        // Inputs, fetched from the API in one pass
+        std::vector<double> _rot[9]; // rotation matrix (local to global) elements m11, m12, m13, m21, ... m33
+        Vector3Array _vel, _lastVel, _weight;
+        std::vector<double> _mass;
+
+        void syncVessels();
+        void fetch();
+        void compute(double dt);
+    };
+
+}
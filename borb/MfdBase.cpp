@@ -11,19 +11,26 @@ namespace borb {
 
     using namespace std;
 
+    SketchpadHelper* MfdBase::getHelper(Sketchpad* skp)
+    {
+        if (!_skh)
+            _skh = make_shared<borb::SketchpadHelper>(skp, GetWidth(), GetHeight());
+        else
+            _skh->Attach(skp, GetWidth(), GetHeight());
+        return _skh.get();
+    }
+
 #ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
     bool MfdBase::Update(oapi::Sketchpad* skp)
     {
-        shared_ptr<borb::SketchpadHelper> skh = make_shared<borb::SketchpadHelper>(skp, GetWidth(), GetHeight());
-        Update(skh.get());
+        Update(getHelper(skp));
         return true;
     }
 #else
     void MfdBase::Update(HDC hDC)
     {
         shared_ptr<borb::Sketchpad> skp = GetSketchpad(hDC);
-        shared_ptr<borb::SketchpadHelper> skh = make_shared<borb::SketchpadHelper>(skp.get(), GetWidth(), GetHeight());
-        Update(skh.get());
+        Update(getHelper(skp.get()));
     }
 #endif
 
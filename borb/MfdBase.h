@@ -9,6 +9,10 @@
 
 #include "SketchpadHelper.h"
 
+#ifdef BORB_SOFTWARE_SKETCHPAD
+#error BORB_SOFTWARE_SKETCHPAD is for the headless build only: MFDs must draw on Orbiter's Sketchpad.
+#endif
+
 namespace borb {
 
     class MfdBase
@@ -40,5 +44,10 @@ namespace borb {
 
     protected:
         VESSEL* _vessel; // owned by Orbiter - rather more readable than "pv"
+
+    private:
+        std::shared_ptr<SketchpadHelper> _skh; // kept from frame to frame, so that its resources and buffers are reused
+
+        SketchpadHelper* getHelper(Sketchpad* skp);
     };
 }
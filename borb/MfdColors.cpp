@@ -7,7 +7,9 @@
 #include <PrecompiledBoostOrbiter.h>
 #include "MfdColors.h"
 
+#ifndef BORB_SOFTWARE_SKETCHPAD
 #include <SimpleIni/SimpleIni.h>
+#endif
 
 // TODO: allow MFDs to define purpose-based colors, which can be assigned to
 // the "standard" MFD colors or custom RGB values via a per-MFD config file.
@@ -38,10 +40,22 @@ namespace borb {
         return 0;
     }
 
+#ifdef BORB_SOFTWARE_SKETCHPAD
+    // The headless build has no Orbiter configuration to read, and its reference images need fixed colors anyway
+    struct defaultColors
+    {
+        long GetOrbiterHexValue(const char* section, const char* key, long defaultValue) { return defaultValue; }
+    };
+#endif
+
     vector<DWORD> _mfdColorClass::loadColorValues()
     {
+#ifdef BORB_SOFTWARE_SKETCHPAD
+        defaultColors ini;
+#else
         CSimpleIni ini;
         ini.LoadFile("Config/MFD/Default.cfg"); // unfortunately this has comments to the right of values which SimpleIni doesn't understand...
+#endif
         vector<DWORD> _colors;
         _colors.push_back(ini.GetOrbiterHexValue("", "COL_0_BRT", 0x00FF00UL));
         _colors.push_back(ini.GetOrbiterHexValue("", "COL_0_DIM", 0x40A040UL));
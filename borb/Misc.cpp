@@ -6,6 +6,7 @@
 
 #include <PrecompiledBoostOrbiter.h>
 #include "Misc.h"
+#include "VesselNameIndex.h"
 
 namespace borb {
 
@@ -40,10 +41,26 @@ namespace borb {
 
     OBJHANDLE GetVesselByName(const string& name)
     {
-        char cstr[256];
-        size_t length = name.copy(cstr, sizeof(cstr) - 1);
-        cstr[length] = 0;
-        return oapiGetVesselByName(cstr);
+        return VesselNames.Find(name);
+    }
+
+    long long GetPreciseTicks()
+    {
+        LARGE_INTEGER ticks;
+        QueryPerformanceCounter(&ticks);
+        return ticks.QuadPart;
+    }
+
+    double PreciseTicksToSeconds(long long ticks)
+    {
+        static double secondsPerTick = 0;
+        if (secondsPerTick == 0)
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            secondsPerTick = 1.0 / (double) frequency.QuadPart;
+        }
+        return ticks * secondsPerTick;
     }
 
     VECTOR3 LocalToHorizon(const VECTOR3& vect, double lon, double lat)
@@ -59,10 +76,31 @@ namespace borb {
         return tmul(matrix_rot_ly(-lon), tmul(matrix_rot_rz(-lat + PI/2), vect));
     }
 
+    RecentAverageTracker::RecentAverageTracker()
+        : _points(64)
+    {
+        _fromTMinusMJD = _toTMinusMJD = 0;
+        _included = 0;
+        _total = _compensation = 0;
+        _count = 0;
+    }
+
+    void RecentAverageTracker::add(double value)
+    {
+        double sum = _total + value;
+        if (abs(_total) >= abs(value))
+            _compensation += (_total - sum) + value;
+        else
+            _compensation += (value - sum) + _total;
+        _total = sum;
+    }
+
     void RecentAverageTracker::Update(double mjd, double value)
     {
         if (_points.size() > 0 && mjd <= _points.back().MJD)
             throw exception("RecentAverageTracker: time must be strictly monotonically increasing.");
+        if (_points.full())
+            _points.set_capacity(_points.capacity() * 2);
         AveragePoint pt;
         pt.MJD = mjd;
         pt.Value = value;
@@ -71,26 +109,25 @@ namespace borb {
         double fr = mjd + _fromTMinusMJD, to = mjd + _toTMinusMJD;
         while (_points.size() > 0 && _points.front().MJD < fr)
         {
-            pt = _points.front();
-            _points.pop_front();
-            if (pt.MJD <= _lastMJD)
+            // a point may leave the window without ever having entered it, if the window is shorter than the update interval
+            if (_included > 0)
             {
-                _total -= pt.Value;
+                add(-_points.front().Value);
                 _count--;
+                _included--;
             }
+            _points.pop_front();
         }
 
-        for (deque<AveragePoint>::iterator i = _points.begin(), end = _points.end(); i < end; ++i)
+        while (_included < _points.size() && _points[_included].MJD <= to)
         {
-            if (i->MJD > _lastMJD && i->MJD <= to)
-            {
-                _total += i->Value;
-                _count++;
-                _lastMJD = i->MJD;
-            }
-            else if (i->MJD > to)
-                break;
+            add(_points[_included].Value);
+            _count++;
+            _included++;
         }
+
+        if (_count == 0)
+            _total = _compensation = 0; // start afresh whenever the window empties, so that no rounding error survives
     }
 
     void RecentAverageTracker::SetWindow(double fromTMinusSeconds, double toTMinusSeconds)
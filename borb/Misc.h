@@ -7,15 +7,9 @@
 
 #include <PrecompiledBoostOrbiter.h>
 
-namespace borb {
+#include "Vector2.h"
 
-    union VECTOR2
-    {
-	    double data[2];
-	    struct { double x, y; };
-        VECTOR2() { x = 0; y = 0; }
-        VECTOR2(double x_, double y_) { x = x_; y = y_; }
-    };
+namespace borb {
 
     bool HadUnhandledException();
     void UnhandledException(const std::exception& ex, const std::string& moduleName);
@@ -31,6 +25,11 @@ namespace borb {
     // Returns a handle to the vessel of the specified name, or NULL if the named vessel could not be found.
     OBJHANDLE GetVesselByName(const std::string& name);
 
+    // Returns the current reading of a high-resolution monotonic counter. Only the difference between two readings
+    // is meaningful; convert it using PreciseTicksToSeconds.
+    long long GetPreciseTicks();
+    double PreciseTicksToSeconds(long long ticks);
+
     // Rotates the specified vector from planetary local frame to a "horizon" frame at the specified lon/lat.
     // The "y" axis of the transformed vector is the component of the original vector pointing away from the
     // planet at the specified lon/lat.
@@ -150,18 +149,26 @@ namespace borb {
         double Value;
     };
 
+    // Averages the values recorded between "from" and "to" seconds ago. Points are kept in a ring buffer that only
+    // grows (by doubling) when the window holds more points than ever before, so Update is amortized O(1) and doesn't
+    // allocate in the steady state. The running sum is compensated, so it doesn't drift however long it runs.
     class RecentAverageTracker
     {
     public:
+        RecentAverageTracker();
+
         void Update(double mjd, double value);
-        double GetAverage() { return _total / (double) _count; }
+        double GetAverage() { return (_total + _compensation) / (double) _count; }
         void SetWindow(double fromTMinusSeconds, double toTMinusSeconds);
 
     private:
         double _fromTMinusMJD, _toTMinusMJD;
-        std::deque<AveragePoint> _points;
-        double _total, _lastMJD;
+        boost::circular_buffer<AveragePoint> _points;
+        size_t _included; // the first this many points are in the window, and in the sum; the rest are still too recent
+        double _total, _compensation; // Neumaier summation: the true sum is _total + _compensation
         int _count;
+
+        void add(double value);
     };
 
     template<typename TMfdClass>
@@ -15,6 +15,12 @@
 //    (so that the user knows who to blame for the almost-crash), and then stops invoking any further callbacks, effectively
 //    shutting down your module. Of course this still doesn't completely prevent your module from CTDing Orbiter...
 //
+// - tasks registered with ModuleBase::Tasks run at their own rates, spread out so they don't all land on one frame.
+//
+// - long computations queued in ModuleBase::Jobs are advanced a little on every frame, within a time budget.
+//
+// - background jobs submitted via ModuleBase::SubmitAsync have their results handed back on the simulation thread.
+//
 // - your module is properly deallocated before shutting down, allowing the use of msvc runtime leak tracking.
 //
 //
@@ -38,6 +44,18 @@
 //
 // - implement callbacks by adding overrides for the methods you're interested in. See documentation in 
 //    borb/Module.h which explains each available override.
+//
+// - optionally, to find out how much time your module spends in each callback, also add:
+//        #define BORB_MODULE_TIMING
+//
+//        This logs a summary of each callback's timings to Orbiter.log every BORB_MODULE_TIMING_SUMMARY_SECONDS
+//        (default 60) and at the end of the simulation, plus a warning whenever a callback takes longer than
+//        BORB_MODULE_TIMING_BUDGET_US microseconds (default 1000). Both may be defined before the include too.
+//
+// - optionally, to see exactly when each callback and each BORB_TRACE_SCOPE (see borb/Trace.h) ran, define
+//    BORB_TRACE in the project settings (so that it applies to every file, not just Module.cpp). At the end of
+//    the simulation the trace is written to BORB_TRACE_FILE (default "<module name>.trace.json" in the Orbiter
+//    folder), which can be opened in chrome://tracing or https://ui.perfetto.dev.
 
 #include "borb.h"
 
@@ -66,6 +84,36 @@
 
 using namespace std;
 
+#ifdef BORB_MODULE_TIMING
+#  ifndef BORB_MODULE_TIMING_BUDGET_US
+#    define BORB_MODULE_TIMING_BUDGET_US 1000
+#  endif
+#  ifndef BORB_MODULE_TIMING_SUMMARY_SECONDS
+#    define BORB_MODULE_TIMING_SUMMARY_SECONDS 60
+#  endif
+borb::CallbackTimings callbackTimings(BORB_MODULE_NAME, BORB_MODULE_TIMING_BUDGET_US, BORB_MODULE_TIMING_SUMMARY_SECONDS);
+#  define BORB_TIME_CALLBACK(callback) borb::CallbackTimer callbackTimer(callbackTimings, callback)
+#  define BORB_LOG_CALLBACK_TIMINGS() callbackTimings.LogSummary()
+#else
+#  define BORB_TIME_CALLBACK(callback)
+#  define BORB_LOG_CALLBACK_TIMINGS()
+#endif
+
+#ifdef BORB_TRACE
+#  ifndef BORB_TRACE_FILE
+#    define BORB_TRACE_FILE BORB_MODULE_NAME ".trace.json"
+#  endif
+#  define BORB_TRACE_CALLBACK(callback) borb::TraceScope callbackTraceScope(borb::GetModuleCallbackName(callback))
+#  define BORB_WRITE_TRACE() \
+    if (!borb::TraceWriteChromeJson(BORB_TRACE_FILE)) \
+        borb::WriteLog(string("Module ") + BORB_MODULE_NAME + ": could not write the trace to " + BORB_TRACE_FILE)
+#else
+#  define BORB_TRACE_CALLBACK(callback)
+#  define BORB_WRITE_TRACE()
+#endif
+
+#define BORB_PROFILE_CALLBACK(callback) BORB_TRACE_CALLBACK(callback); BORB_TIME_CALLBACK(callback)
+
 void StartLeakMonitor();
 void LogLeaks();
 
@@ -149,7 +197,9 @@ DLLCLBK void opcOpenRenderViewport(HWND renderWnd, DWORD width, DWORD height, bo
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackOpenRenderViewport);
         loadGlobalSettings(); // load on simulation start, so that any changes the user made to the file between sessions are effected
+        BORB_MODULE_VARIABLE->Tasks.Reset();
         BORB_MODULE_VARIABLE->SimulationStart();
     }
     catch (exception& ex)
@@ -164,13 +214,20 @@ DLLCLBK void opcCloseRenderViewport()
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackCloseRenderViewport);
         BORB_MODULE_VARIABLE->SimulationEnd();
+        BORB_MODULE_VARIABLE->Jobs.CancelAll();
+        BORB_MODULE_VARIABLE->Workers.Shutdown();
+        borb::VesselNames.Clear();
+        borb::SketchpadResources.Clear();
         saveGlobalSettings();
     }
     catch (exception& ex)
     {
         borb::UnhandledException(ex, BORB_MODULE_NAME);
     }
+    BORB_LOG_CALLBACK_TIMINGS();
+    BORB_WRITE_TRACE();
 }
 
 
@@ -180,8 +237,10 @@ DLLCLBK void opcLoadState(FILEHANDLE scn)
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackLoadState);
         borb::ScenarioNode root;
         root.LoadFrom(scn);
+        borb::VesselNames.Rebuild(); // so that loading per-vessel state doesn't do a linear search per vessel
         BORB_MODULE_VARIABLE->LoadFromScenario(&root);
     }
     catch (exception& ex)
@@ -196,6 +255,7 @@ DLLCLBK void opcSaveState(FILEHANDLE scn)
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackSaveState);
         borb::ScenarioNode root;
         BORB_MODULE_VARIABLE->SaveToScenario(&root);
         if (!root.IsEmpty())
@@ -214,7 +274,11 @@ DLLCLBK void opcPreStep(double simt, double simdt, double mjd)
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackPreStep);
+        BORB_MODULE_VARIABLE->Workers.DispatchCompleted();
         BORB_MODULE_VARIABLE->PreStep(simt, simdt, mjd);
+        BORB_MODULE_VARIABLE->Tasks.Run(simt, simdt, mjd);
+        BORB_MODULE_VARIABLE->Jobs.Run();
     }
     catch (exception& ex)
     {
@@ -228,6 +292,7 @@ DLLCLBK void opcPostStep(double simt, double simdt, double mjd)
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackPostStep);
         BORB_MODULE_VARIABLE->PostStep(simt, simdt, mjd);
     }
     catch (exception& ex)
@@ -242,7 +307,9 @@ DLLCLBK void opcDeleteVessel(OBJHANDLE hVessel)
         return;
     try
     {
+        BORB_PROFILE_CALLBACK(borb::ModuleCallbackDeleteVessel);
         BORB_MODULE_VARIABLE->DeleteVessel(oapiGetVesselInterface(hVessel));
+        borb::VesselNames.Remove(hVessel);
     }
     catch (exception& ex)
     {
@@ -6,6 +6,9 @@
 #pragma once
 
 #include "ScenarioTree.h"
+#include "TaskScheduler.h"
+#include "TimeSlicedJob.h"
+#include "WorkerPool.h"
 
 namespace borb {
 
@@ -36,13 +39,30 @@ namespace borb {
         // to be a valid instance, but may be completely empty (e.g. first ever use of this module).
         virtual void LoadFromScenario(borb::ScenarioNode* node) { }
 
-        // Called before every time step. Keep this as fast as possible.
+        // Called before every time step. Keep this as fast as possible; work that doesn't need to happen on every frame
+        // is better registered with Tasks.
         virtual void PreStep(double simt, double simdt, double mjd) { }
         // Called after every time step. Keep this as fast as possible.
         virtual void PostStep(double simt, double simdt, double mjd) { }
 
         // Called whenever a vessel is deleted. This is the module's last chance to access this vessel.
         virtual void DeleteVessel(VESSEL* vessel) { }
+
+        // Work to be done at a fixed rate, e.g. 10 times per simulated second, rather than on every frame. Tasks are run
+        // after every PreStep, and may be added at any time, including in the module's constructor.
+        TaskScheduler Tasks;
+
+        // Long-running computations added to this queue are advanced after every PreStep, within the queue's per-frame
+        // time budget. Any jobs still running when the simulation ends are cancelled.
+        TimeSlicedJobQueue Jobs;
+
+        // Queues a job for computation on a background thread; see AsyncJob for what it may and may not do there. The
+        // job's Complete method is called on the simulation thread at the start of a later PreStep.
+        void SubmitAsync(const std::shared_ptr<AsyncJob>& job) { Workers.Submit(job); }
+
+        // The thread pool behind SubmitAsync. The threads are started on first use and stopped when the simulation ends,
+        // discarding any jobs that haven't started computing.
+        WorkerPool Workers;
     };
 
 }
\ No newline at end of file
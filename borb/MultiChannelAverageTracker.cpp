@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "MultiChannelAverageTracker.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace borb {
+
+    using namespace std;
+
+    MultiChannelAverageTracker::MultiChannelAverageTracker(int channelCount)
+    {
+        if (channelCount <= 0)
+            throw exception("MultiChannelAverageTracker: the channel count must be positive.");
+        _channels = channelCount;
+        _fromTMinusMJD = _toTMinusMJD = 0;
+        _capacity = 64;
+        _mjds.resize(_capacity);
+        _values.resize(_capacity * _channels);
+        _first = _size = _included = 0;
+        _count = 0;
+        _sums.resize(_channels);
+        _compensations.resize(_channels);
+    }
+
+    void MultiChannelAverageTracker::SetWindow(double fromTMinusSeconds, double toTMinusSeconds)
+    {
+        _fromTMinusMJD = -abs(fromTMinusSeconds) / 86400;
+        _toTMinusMJD = -abs(toTMinusSeconds) / 86400;
+    }
+
+    void MultiChannelAverageTracker::grow()
+    {
+        size_t capacity = _capacity * 2;
+        vector<double> mjds(capacity), values(capacity * _channels);
+        for (size_t i = 0; i < _size; i++)
+        {
+            size_t from = ringIndex(i);
+            mjds[i] = _mjds[from];
+            memcpy(&values[i * _channels], &_values[from * _channels], _channels * sizeof(double));
+        }
+        _mjds.swap(mjds);
+        _values.swap(values);
+        _capacity = capacity;
+        _first = 0;
+    }
+
+    // Adds (sign = 1) or subtracts (sign = -1) the row at the specified ring index to the sums
+    void MultiChannelAverageTracker::addRow(size_t index, double sign)
+    {
+        const double* row = &_values[index * _channels];
+        double* sums = &_sums[0];
+        double* compensations = &_compensations[0];
+        // The SSE2 loop does two channels at a time, in the same order of operations as the scalar loop, which
+        // finishes off the remainder, so the sums don't depend on which of the two handled a channel.
+        int c = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+        __m128d vSign = _mm_set1_pd(sign);
+        for (; c + 2 <= _channels; c += 2)
+        {
+            __m128d sum = _mm_loadu_pd(sums + c);
+            __m128d y = _mm_sub_pd(_mm_mul_pd(vSign, _mm_loadu_pd(row + c)), _mm_loadu_pd(compensations + c));
+            __m128d t = _mm_add_pd(sum, y);
+            _mm_storeu_pd(compensations + c, _mm_sub_pd(_mm_sub_pd(t, sum), y));
+            _mm_storeu_pd(sums + c, t);
+        }
+#endif
+        for (; c < _channels; c++)
+        {
+            double y = sign * row[c] - compensations[c];
+            double t = sums[c] + y;
+            compensations[c] = (t - sums[c]) - y;
+            sums[c] = t;
+        }
+    }
+
+    void MultiChannelAverageTracker::Update(double mjd, const double* values)
+    {
+        if (_size > 0 && mjd <= _mjds[ringIndex(_size - 1)])
+            throw exception("MultiChannelAverageTracker: time must be strictly monotonically increasing.");
+        if (_size == _capacity)
+            grow();
+        size_t index = ringIndex(_size);
+        _mjds[index] = mjd;
+        memcpy(&_values[index * _channels], values, _channels * sizeof(double));
+        _size++;
+
+        double fr = mjd + _fromTMinusMJD, to = mjd + _toTMinusMJD;
+        while (_size > 0 && _mjds[_first] < fr)
+        {
+            // a row may leave the window without ever having entered it, if the window is shorter than the update interval
+            if (_included > 0)
+            {
+                addRow(_first, -1);
+                _count--;
+                _included--;
+            }
+            _first = (_first + 1) % _capacity;
+            _size--;
+        }
+
+        while (_included < _size && _mjds[ringIndex(_included)] <= to)
+        {
+            addRow(ringIndex(_included), 1);
+            _count++;
+            _included++;
+        }
+
+        if (_count == 0)
+        {
+            // start afresh whenever the window empties, so that no rounding error survives
+            fill(_sums.begin(), _sums.end(), 0.0);
+            fill(_compensations.begin(), _compensations.end(), 0.0);
+        }
+    }
+
+    void MultiChannelAverageTracker::GetAverages(double* averages)
+    {
+        for (int c = 0; c < _channels; c++)
+            averages[c] = _sums[c] / (double) _count;
+    }
+
+}
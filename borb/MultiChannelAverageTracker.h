@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    // Equivalent to a set of RecentAverageTrackers with the same window, all updated at the same times, but storing
+    // each timestamp once and advancing the window once for all the channels. The values of each update are stored
+    // as one contiguous row, so adding a row to (or removing it from) the running sums is a single tight loop over the
+    // channels, done two channels at a time with SSE2. Sums use Kahan compensation, which unlike Neumaier's variant
+    // has no branches, so both channels of a pair take the same path.
+    class MultiChannelAverageTracker
+    {
+    public:
+        MultiChannelAverageTracker(int channelCount);
+
+        // Records one value per channel; "values" must point to GetChannelCount() values.
+        void Update(double mjd, const double* values);
+        void SetWindow(double fromTMinusSeconds, double toTMinusSeconds);
+
+        int GetChannelCount() { return _channels; }
+        // The number of updates in the window. Averages are NaN while this is 0.
+        int GetCount() { return _count; }
+        double GetAverage(int channel) { return _sums[channel] / (double) _count; }
+        // Writes the average of every channel to "averages", which must have room for GetChannelCount() values.
+        void GetAverages(double* averages);
+
+    private:
+        int _channels;
+        double _fromTMinusMJD, _toTMinusMJD;
+        // A ring of rows: _mjds[i] is the time of row i, and _values[i * _channels ...] its values.
+        std::vector<double> _mjds, _values;
+        size_t _capacity, _first, _size; // _first is the ring index of the oldest row
+        size_t _included; // the oldest this many rows are in the window, and in the sums; the rest are still too recent
+        int _count;
+        std::vector<double> _sums, _compensations;
+
+        size_t ringIndex(size_t position) { return (_first + position) % _capacity; }
+        void grow();
+        void addRow(size_t index, double sign);
+    };
+
+}
@@ -0,0 +1,225 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "RecentStatsTracker.h"
+
+namespace borb {
+
+    using namespace std;
+
+    static const double NaN = numeric_limits<double>::quiet_NaN();
+
+    void P2QuantileEstimator::Add(double value)
+    {
+        if (_count < 5)
+        {
+            // insertion sort into the first five markers
+            int i = _count;
+            for (; i > 0 && _q[i - 1] > value; i--)
+                _q[i] = _q[i - 1];
+            _q[i] = value;
+            _count++;
+            if (_count == 5)
+            {
+                for (int j = 0; j < 5; j++)
+                    _n[j] = j;
+                _np[0] = 0; _np[1] = 2 * _p; _np[2] = 4 * _p; _np[3] = 2 + 2 * _p; _np[4] = 4;
+            }
+            return;
+        }
+        _count++;
+
+        int k;
+        if (value < _q[0])
+        {
+            _q[0] = value;
+            k = 0;
+        }
+        else if (value >= _q[4])
+        {
+            _q[4] = value;
+            k = 3;
+        }
+        else
+            for (k = 0; value >= _q[k + 1]; k++) { }
+
+        for (int i = k + 1; i < 5; i++)
+            _n[i]++;
+        _np[1] += _p / 2;
+        _np[2] += _p;
+        _np[3] += (1 + _p) / 2;
+        _np[4] += 1;
+
+        for (int i = 1; i <= 3; i++)
+        {
+            double d = _np[i] - _n[i];
+            if ((d >= 1 && _n[i + 1] - _n[i] > 1) || (d <= -1 && _n[i - 1] - _n[i] < -1))
+            {
+                int step = d > 0 ? 1 : -1;
+                double q = parabolic(i, step);
+                _q[i] = _q[i - 1] < q && q < _q[i + 1] ? q : linear(i, step);
+                _n[i] += step;
+            }
+        }
+    }
+
+    double P2QuantileEstimator::parabolic(int i, double d)
+    {
+        return _q[i] + d / (_n[i + 1] - _n[i - 1]) * (
+            (_n[i] - _n[i - 1] + d) * (_q[i + 1] - _q[i]) / (_n[i + 1] - _n[i]) +
+            (_n[i + 1] - _n[i] - d) * (_q[i] - _q[i - 1]) / (_n[i] - _n[i - 1]));
+    }
+
+    double P2QuantileEstimator::linear(int i, int d)
+    {
+        return _q[i] + d * (_q[i + d] - _q[i]) / (_n[i + d] - _n[i]);
+    }
+
+    double P2QuantileEstimator::GetQuantile()
+    {
+        if (_count == 0)
+            return NaN;
+        if (_count >= 5)
+            return _q[2];
+        return _q[min(_count - 1, (int) (_p * _count))];
+    }
+
+
+
+    RecentStatsTracker::RecentStatsTracker(double quantile)
+        : _points(64), _minQueue(64), _maxQueue(64)
+    {
+        _fromTMinusMJD = _toTMinusMJD = 0;
+        _included = 0;
+        _count = 0;
+        _mean = _m2 = 0;
+        _quantiles[0] = _quantiles[1] = P2QuantileEstimator(quantile);
+        _quantileRestartMJD[0] = _quantileRestartMJD[1] = -numeric_limits<double>::infinity();
+    }
+
+    void RecentStatsTracker::SetWindow(double fromTMinusSeconds, double toTMinusSeconds)
+    {
+        _fromTMinusMJD = -abs(fromTMinusSeconds) / 86400;
+        _toTMinusMJD = -abs(toTMinusSeconds) / 86400;
+    }
+
+    void RecentStatsTracker::pushGrowing(boost::circular_buffer<AveragePoint>& buffer, const AveragePoint& pt)
+    {
+        if (buffer.full())
+            buffer.set_capacity(buffer.capacity() * 2);
+        buffer.push_back(pt);
+    }
+
+    void RecentStatsTracker::include(const AveragePoint& pt)
+    {
+        _count++;
+        double delta = pt.Value - _mean;
+        _mean += delta / _count;
+        _m2 += delta * (pt.Value - _mean);
+
+        // Values that can never again be the minimum (maximum), because a newer value is at least as small (large), are dropped
+        while (!_minQueue.empty() && _minQueue.back().Value >= pt.Value)
+            _minQueue.pop_back();
+        pushGrowing(_minQueue, pt);
+        while (!_maxQueue.empty() && _maxQueue.back().Value <= pt.Value)
+            _maxQueue.pop_back();
+        pushGrowing(_maxQueue, pt);
+
+        double windowMJD = _toTMinusMJD - _fromTMinusMJD;
+        if (_quantileRestartMJD[0] == -numeric_limits<double>::infinity())
+        {
+            // first point ever: stagger the two estimators by half a window
+            _quantileRestartMJD[0] = pt.MJD;
+            _quantileRestartMJD[1] = pt.MJD + windowMJD / 2;
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            if (pt.MJD >= _quantileRestartMJD[i])
+            {
+                _quantiles[i].Reset();
+                _quantileRestartMJD[i] = pt.MJD + windowMJD;
+            }
+            _quantiles[i].Add(pt.Value);
+        }
+    }
+
+    void RecentStatsTracker::exclude(const AveragePoint& pt)
+    {
+        _count--;
+        if (_count == 0)
+            _mean = _m2 = 0; // start afresh whenever the window empties, so that no rounding error survives
+        else
+        {
+            double delta = pt.Value - _mean;
+            _mean -= delta / _count;
+            _m2 -= delta * (pt.Value - _mean);
+            if (_m2 < 0)
+                _m2 = 0;
+        }
+
+        if (!_minQueue.empty() && _minQueue.front().MJD == pt.MJD)
+            _minQueue.pop_front();
+        if (!_maxQueue.empty() && _maxQueue.front().MJD == pt.MJD)
+            _maxQueue.pop_front();
+    }
+
+    void RecentStatsTracker::Update(double mjd, double value)
+    {
+        if (_points.size() > 0 && mjd <= _points.back().MJD)
+            throw exception("RecentStatsTracker: time must be strictly monotonically increasing.");
+        AveragePoint pt;
+        pt.MJD = mjd;
+        pt.Value = value;
+        pushGrowing(_points, pt);
+
+        double fr = mjd + _fromTMinusMJD, to = mjd + _toTMinusMJD;
+        while (_points.size() > 0 && _points.front().MJD < fr)
+        {
+            if (_included > 0)
+            {
+                exclude(_points.front());
+                _included--;
+            }
+            _points.pop_front();
+        }
+
+        while (_included < _points.size() && _points[_included].MJD <= to)
+        {
+            include(_points[_included]);
+            _included++;
+        }
+    }
+
+    double RecentStatsTracker::GetMin()
+    {
+        return _count == 0 ? NaN : _minQueue.front().Value;
+    }
+
+    double RecentStatsTracker::GetMax()
+    {
+        return _count == 0 ? NaN : _maxQueue.front().Value;
+    }
+
+    double RecentStatsTracker::GetMean()
+    {
+        return _count == 0 ? NaN : _mean;
+    }
+
+    double RecentStatsTracker::GetVariance()
+    {
+        return _count == 0 ? NaN : _m2 / _count;
+    }
+
+    double RecentStatsTracker::GetQuantile()
+    {
+        if (_count == 0)
+            return NaN;
+        int older = _quantileRestartMJD[0] <= _quantileRestartMJD[1] ? 0 : 1;
+        return _quantiles[older].GetCount() > 0 ? _quantiles[older].GetQuantile() : _quantiles[1 - older].GetQuantile();
+    }
+
+}
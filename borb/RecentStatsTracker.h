@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "Misc.h"
+
+namespace borb {
+
+    // Estimates a single quantile of a stream of values without storing them, using the P-squared algorithm of Jain
+    // and Chlamtac: five markers track the minimum, the maximum, the quantile and two points either side of it, and
+    // are nudged towards their ideal positions with piecewise-parabolic interpolation as each value arrives.
+    class P2QuantileEstimator
+    {
+    public:
+        P2QuantileEstimator(double quantile = 0.5) { _p = quantile; Reset(); }
+
+        void Reset() { _count = 0; }
+        void Add(double value);
+        int GetCount() { return _count; }
+        // Returns the estimate, or NaN if no values have been added.
+        double GetQuantile();
+
+    private:
+        double _p;
+        int _count;
+        double _q[5]; // marker heights; while _count < 5, simply the values seen so far, in order
+        double _n[5]; // actual marker positions
+        double _np[5]; // desired marker positions
+
+        double parabolic(int i, double d);
+        double linear(int i, int d);
+    };
+
+    // Tracks statistics of the values recorded between "from" and "to" seconds ago, with the same window semantics as
+    // RecentAverageTracker: minimum and maximum (exact, via monotonic queues), mean and variance (exact, via Welford's
+    // algorithm extended to remove values), and one quantile, e.g. the median (approximate, see GetQuantile). Update
+    // is amortized O(1) and, once the buffers have grown to fit the window, never allocates.
+    class RecentStatsTracker
+    {
+    public:
+        RecentStatsTracker(double quantile = 0.5);
+
+        void Update(double mjd, double value);
+        void SetWindow(double fromTMinusSeconds, double toTMinusSeconds);
+
+        // The number of values in the window. All the other getters return NaN while this is 0.
+        int GetCount() { return _count; }
+        double GetMin();
+        double GetMax();
+        double GetMean();
+        double GetVariance(); // of the population, i.e. divided by GetCount()
+        double GetStdDev() { return sqrt(GetVariance()); }
+        // Returns the estimate of the quantile specified in the constructor. P-squared can't forget values, so two
+        // estimators are used, each restarted every window length, half a window apart; this returns the older one.
+        // The estimate therefore covers between a half and the whole of the window, rather than exactly the window.
+        double GetQuantile();
+
+    private:
+        double _fromTMinusMJD, _toTMinusMJD;
+        boost::circular_buffer<AveragePoint> _points;
+        boost::circular_buffer<AveragePoint> _minQueue, _maxQueue; // window points with increasing/decreasing values
+        size_t _included; // the first this many points are in the window; the rest are still too recent
+        int _count;
+        double _mean, _m2; // Welford's running mean and sum of squared deviations
+        P2QuantileEstimator _quantiles[2];
+        double _quantileRestartMJD[2];
+
+        void include(const AveragePoint& pt);
+        void exclude(const AveragePoint& pt);
+        static void pushGrowing(boost::circular_buffer<AveragePoint>& buffer, const AveragePoint& pt);
+    };
+
+}
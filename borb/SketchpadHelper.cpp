@@ -6,12 +6,19 @@
 
 #include <PrecompiledBoostOrbiter.h>
 #include "SketchpadHelper.h"
+#include "SketchpadResources.h"
+#include "DisplayList.h"
+#include "SoftwareSketchpad.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace borb {
 
     using namespace std;
 
-#ifndef USE_ORBITERSDK_2010P1_OR_HIGHER
+#if !defined(BORB_OAPI_SKETCHPAD) && !defined(BORB_SOFTWARE_SKETCHPAD)
 
     class Sketchpad : private boost::noncopyable
     {
@@ -38,6 +45,7 @@ namespace borb {
         void Rectangle(int x1, int y1, int x2, int y2);
         void Ellipse(int x1, int y1, int x2, int y2);
         void Polygon(const IVECTOR2* pts, int count);
+        void Polyline(const IVECTOR2* pts, int count);
         void Text(int x, int y, const string& text, HORZALIGN horzAlign, VERTALIGN vertAlign);
         void TextBox(int x1, int y1, int x2, int y2, const string& text);
     };
@@ -209,6 +217,11 @@ namespace borb {
         ::Polygon(HandleDC, (const POINT*) pts, count);
     }
 
+    void Sketchpad::Polyline(const IVECTOR2* pts, int count)
+    {
+        ::Polyline(HandleDC, (const POINT*) pts, count);
+    }
+
     void Sketchpad::Text(int x, int y, const string& text, HORZALIGN horzAlign, VERTALIGN vertAlign)
     {
         UINT horzflag = horzAlign == HA_CENTER ? TA_CENTER : horzAlign == HA_RIGHT ? TA_RIGHT : TA_LEFT;
@@ -231,10 +244,16 @@ namespace borb {
 
 #endif
 
+    // Counts the resources released by the functions below. A newly created resource can reuse the address of a released
+    // one, so SketchpadHelper only trusts a comparison of resource pointers while this count is unchanged.
+    static unsigned releasedResources = 0;
+
     Brush* CreateBrush(DWORD color)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+#ifdef BORB_OAPI_SKETCHPAD
         return oapiCreateBrush(color);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        return new Brush(color);
 #else
         return new Brush(::CreateSolidBrush(color));
 #endif
@@ -242,8 +261,11 @@ namespace borb {
 
     void ReleaseBrush(Brush* brush)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+        releasedResources++;
+#ifdef BORB_OAPI_SKETCHPAD
         oapiReleaseBrush(brush);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        delete brush;
 #else
         brush->Unselect();
         DeleteObject(brush->HandleBrush);
@@ -253,8 +275,10 @@ namespace borb {
 
     Pen* CreatePen(PENSTYLE style, int width, DWORD color)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+#ifdef BORB_OAPI_SKETCHPAD
         return oapiCreatePen((int) style, width, color);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        return new Pen(style, width, color);
 #else
         int pstyle = style == PEN_INVISIBLE ? PS_NULL : style == PEN_DASHED ? PS_DOT : PS_SOLID;
         return new Pen(::CreatePen(pstyle, width, color));
@@ -263,8 +287,11 @@ namespace borb {
 
     void ReleasePen(Pen* pen)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+        releasedResources++;
+#ifdef BORB_OAPI_SKETCHPAD
         oapiReleasePen(pen);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        delete pen;
 #else
         pen->Unselect();
         DeleteObject(pen->HandlePen);
@@ -274,8 +301,10 @@ namespace borb {
 
     Font* CreateFont(int height, bool proportional, const string& typeface, FONTSTYLE style, int orientation)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+#ifdef BORB_OAPI_SKETCHPAD
         return oapiCreateFont(height, proportional, typeface.c_str(), (FontStyle) style, orientation);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        return new Font(height, style);
 #else
         LOGFONT fontdesc = {};
         fontdesc.lfHeight = height;
@@ -298,8 +327,11 @@ namespace borb {
 
     void ReleaseFont(Font* font)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+        releasedResources++;
+#ifdef BORB_OAPI_SKETCHPAD
         oapiReleaseFont(font);
+#elif defined(BORB_SOFTWARE_SKETCHPAD)
+        delete font;
 #else
         font->Unselect();
         DeleteObject(font->HandleFont);
@@ -310,9 +342,34 @@ namespace borb {
 
 
     SketchpadHelper::SketchpadHelper(Sketchpad* sketchpad, int width, int height)
+    {
+        _dispSize = -1;
+        _resourceGeneration = SketchpadResources.GetGeneration();
+        Attach(sketchpad, width, height);
+    }
+
+    void SketchpadHelper::Attach(Sketchpad* sketchpad, int width, int height)
     {
         _sketchpad = sketchpad;
-        _dispSize = min(width, height); // maintain a square display even if this means leaving a blank area. Chances are that MFDs will stay square forever.
+        _recording = NULL;
+        _batching = false;
+        _simplify = false;
+        memset(&_state, 0, sizeof(_state)); // nothing is known about the Sketchpad's state yet
+        _releasedResources = releasedResources;
+
+        int dispSize = min(width, height); // maintain a square display even if this means leaving a blank area. Chances are that MFDs will stay square forever.
+        if (dispSize != _dispSize || _resourceGeneration != SketchpadResources.GetGeneration())
+        {
+            // The fonts are sized for the display, and everything is stale if the cache has been cleared since
+            _pensStdSolid.clear();
+            _pensStdDashed.clear();
+            _brushesStd.clear();
+            _penInvisible.reset();
+            _fontProportional.reset();
+            _fontMonospace.reset();
+            _resourceGeneration = SketchpadResources.GetGeneration();
+        }
+        _dispSize = dispSize;
         _unitSize = (double) _dispSize / 20.0;
         
         _originX = _originY = 0;
@@ -350,21 +407,21 @@ namespace borb {
     Font* SketchpadHelper::GetFontProportional()
     {
         if (!_fontProportional)
-            _fontProportional = MakeFont(1.0, true, "Sans");
+            _fontProportional = SketchpadResources.GetFont(calcFontHeight(1.0), true, "Sans");
         return _fontProportional.get();
     }
 
     Font* SketchpadHelper::GetFontMonospace()
     {
         if (!_fontMonospace)
-            _fontMonospace = MakeFont(1.0, false, "Fixed");
+            _fontMonospace = SketchpadResources.GetFont(calcFontHeight(1.0), false, "Fixed");
         return _fontMonospace.get();
     }
 
     Pen* SketchpadHelper::GetPenInvisible()
     {
         if (!_penInvisible)
-            _penInvisible = MakePen(PEN_INVISIBLE, 0, 0);
+            _penInvisible = SketchpadResources.GetPen(PEN_INVISIBLE, 0, 0);
         return _penInvisible.get();
     }
 
@@ -376,7 +433,7 @@ namespace borb {
             while (index >= _pensStdSolid.size())
                 _pensStdSolid.push_back(shared_ptr<Pen>());
             if (!_pensStdSolid[index])
-                _pensStdSolid[index] = MakePen(PEN_SOLID, 0, MfdColorValue.FromEnum(color));
+                _pensStdSolid[index] = SketchpadResources.GetPen(PEN_SOLID, 0, MfdColorValue.FromEnum(color));
             return _pensStdSolid[index].get();
         }
         else
@@ -384,7 +441,7 @@ namespace borb {
             while (index >= _pensStdDashed.size())
                 _pensStdDashed.push_back(shared_ptr<Pen>());
             if (!_pensStdDashed[index])
-                _pensStdDashed[index] = MakePen(PEN_DASHED, 0, MfdColorValue.FromEnum(color));
+                _pensStdDashed[index] = SketchpadResources.GetPen(PEN_DASHED, 0, MfdColorValue.FromEnum(color));
             return _pensStdDashed[index].get();
         }
     }
@@ -395,101 +452,412 @@ namespace borb {
         while (index >= _brushesStd.size())
             _brushesStd.push_back(shared_ptr<Brush>());
         if (!_brushesStd[index])
-            _brushesStd[index] = MakeBrush(MfdColorValue.FromEnum(color));
+            _brushesStd[index] = SketchpadResources.GetBrush(MfdColorValue.FromEnum(color));
         return _brushesStd[index].get();
     }
 
 
 
+    static DisplayCommand makeCommand(DisplayOp op, int a = 0, int b = 0, int c = 0, int d = 0)
+    {
+        DisplayCommand cmd;
+        cmd.Op = op;
+        cmd.Args[0] = a;
+        cmd.Args[1] = b;
+        cmd.Args[2] = c;
+        cmd.Args[3] = d;
+        cmd.Count = cmd.Data = 0;
+        cmd.Resource = NULL;
+        cmd.Color = 0;
+        return cmd;
+    }
+
+    static DisplayCommand makeCommand(DisplayOp op, void* resource)
+    {
+        DisplayCommand cmd = makeCommand(op);
+        cmd.Resource = resource;
+        return cmd;
+    }
+
+    static DisplayCommand makeCommand(DisplayOp op, DWORD color)
+    {
+        DisplayCommand cmd = makeCommand(op);
+        cmd.Color = color;
+        return cmd;
+    }
+
+    // Every drawing operation goes through here, so that it can be recorded into the current display list section
+    void SketchpadHelper::issue(const DisplayCommand& cmd, const IVECTOR2* points, const char* text)
+    {
+        if (_recording != NULL)
+            _recording->add(cmd, points, text);
+        dispatch(cmd, points, text);
+    }
+
+    void SketchpadHelper::dispatch(const DisplayCommand& cmd, const IVECTOR2* points, const char* text)
+    {
+        if (_batching)
+            queue(cmd, points, text);
+        else
+            execute(cmd, points, text);
+    }
+
+    // Returns true if the state must be set, i.e. it's unknown or different, and marks it as known
+    bool SketchpadHelper::changeState(unsigned flag, bool same)
+    {
+        if ((_state.Known & flag) && same)
+            return false;
+        _state.Known |= flag;
+        return true;
+    }
+
+    // Returns true if the font, pen or brush must be selected, like changeState. The selected one is only assumed to
+    // be the same as the requested one if no resource has been released since it was selected: otherwise the pointers
+    // could be equal merely because a new resource took the released one's place.
+    bool SketchpadHelper::changeResource(unsigned flag, bool same)
+    {
+        if (_releasedResources != releasedResources)
+        {
+            _state.Known &= ~(stateFont | statePen | stateBrush);
+            _releasedResources = releasedResources;
+        }
+        return changeState(flag, same);
+    }
+
+    void SketchpadHelper::execute(const DisplayCommand& cmd, const IVECTOR2* points, const char* text)
+    {
+        const int* a = cmd.Args;
+        switch (cmd.Op)
+        {
+            case DisplayOpSetFont:
+                if (changeResource(stateFont, _state.CurFont == cmd.Resource))
+                    _sketchpad->SetFont(_state.CurFont = (Font*) cmd.Resource);
+                break;
+            case DisplayOpSetPen:
+                if (changeResource(statePen, _state.CurPen == cmd.Resource))
+                    _sketchpad->SetPen(_state.CurPen = (Pen*) cmd.Resource);
+                break;
+            case DisplayOpSetBrush:
+                if (changeResource(stateBrush, _state.CurBrush == cmd.Resource))
+                    _sketchpad->SetBrush(_state.CurBrush = (Brush*) cmd.Resource);
+                break;
+            case DisplayOpSetTextColor:
+                if (changeState(stateTextColor, _state.TextColor == cmd.Color))
+                    _sketchpad->SetTextColor(_state.TextColor = cmd.Color);
+                break;
+            case DisplayOpSetTextBackColor:
+                if (changeState(stateBackground, _state.BackOpaque && _state.BackColor == cmd.Color))
+                {
+#ifdef BORB_OAPI_SKETCHPAD
+                    _sketchpad->SetBackgroundMode(oapi::Sketchpad::BK_OPAQUE);
+                    _sketchpad->SetBackgroundColor(cmd.Color);
+#else
+                    _sketchpad->SetTextBackColor(cmd.Color);
+#endif
+                    _state.BackOpaque = true;
+                    _state.BackColor = cmd.Color;
+                }
+                break;
+            case DisplayOpSetTextBackTransparent:
+                if (changeState(stateBackground, !_state.BackOpaque))
+                {
+#ifdef BORB_OAPI_SKETCHPAD
+                    _sketchpad->SetBackgroundMode(oapi::Sketchpad::BK_TRANSPARENT);
+#else
+                    _sketchpad->SetTextBackTransparent();
+#endif
+                    _state.BackOpaque = false;
+                }
+                break;
+            case DisplayOpMoveTo:
+                _sketchpad->MoveTo(a[0], a[1]);
+                break;
+            case DisplayOpLineTo:
+                _sketchpad->LineTo(a[0], a[1]);
+                break;
+            case DisplayOpLine:
+                _sketchpad->Line(a[0], a[1], a[2], a[3]);
+                break;
+            case DisplayOpRectangle:
+                _sketchpad->Rectangle(a[0], a[1], a[2], a[3]);
+                break;
+            case DisplayOpEllipse:
+                _sketchpad->Ellipse(a[0], a[1], a[2], a[3]);
+                break;
+            case DisplayOpPolygon:
+                _sketchpad->Polygon(points, cmd.Count);
+                break;
+            case DisplayOpPolyline:
+                _sketchpad->Polyline(points, cmd.Count);
+                break;
+            case DisplayOpText:
+#ifdef BORB_OAPI_SKETCHPAD
+                if (changeState(stateAlign, _state.HorzAlign == a[2] && _state.VertAlign == a[3]))
+                    _sketchpad->SetTextAlign((oapi::Sketchpad::TAlign_horizontal) (_state.HorzAlign = a[2]), (oapi::Sketchpad::TAlign_vertical) (_state.VertAlign = a[3]));
+                _sketchpad->Text(a[0], a[1], text, cmd.Count);
+#else
+                _sketchpad->Text(a[0], a[1], string(text, cmd.Count), (HORZALIGN) a[2], (VERTALIGN) a[3]);
+#endif
+                break;
+            case DisplayOpTextBox:
+#ifdef BORB_OAPI_SKETCHPAD
+                if (changeState(stateAlign, _state.HorzAlign == HA_LEFT && _state.VertAlign == VA_TOP))
+                    _sketchpad->SetTextAlign((oapi::Sketchpad::TAlign_horizontal) (_state.HorzAlign = HA_LEFT), (oapi::Sketchpad::TAlign_vertical) (_state.VertAlign = VA_TOP));
+                _sketchpad->TextBox(a[0], a[1], a[2], a[3], text, cmd.Count);
+#else
+                _sketchpad->TextBox(a[0], a[1], a[2], a[3], string(text, cmd.Count));
+#endif
+                break;
+        }
+    }
+
+
+
+    bool SketchpadHelper::BeginSection(DisplayList& list, size_t hash)
+    {
+        if (_recording != NULL)
+            throw runtime_error("SketchpadHelper: display list sections cannot be nested.");
+        int generation = SketchpadResources.GetGeneration();
+        if (list.isCurrent(hash, _dispSize, _originX, _originY, generation))
+        {
+            const vector<DisplayCommand>& commands = list._commands;
+            for (size_t i = 0; i < commands.size(); i++)
+                dispatch(commands[i], list.getPoints(commands[i]), list.getText(commands[i]));
+            return false;
+        }
+        list.begin(hash, _dispSize, _originX, _originY, generation);
+        _recording = &list;
+        return true;
+    }
+
+    void SketchpadHelper::EndSection()
+    {
+        if (_recording == NULL)
+            throw runtime_error("SketchpadHelper: EndSection called without a matching BeginSection that returned true.");
+        _recording->_valid = true;
+        _recording = NULL;
+    }
+
+
+
+    void SketchpadHelper::BeginBatch()
+    {
+        if (_batching)
+            throw runtime_error("SketchpadHelper: batches cannot be nested.");
+        if (!_batch)
+            _batch = make_shared<DisplayList>();
+        // A previous batch may have been abandoned by an exception (and then Attach) before EndBatch cleared it
+        _batchEntries.clear();
+        _batch->begin(0, 0, 0, 0, 0);
+        _batching = true;
+        _batchState = _state;
+        _batchHasPos = false;
+    }
+
+    void SketchpadHelper::queue(const DisplayCommand& cmd, const IVECTOR2* points, const char* text)
+    {
+        drawState& st = _batchState;
+        switch (cmd.Op)
+        {
+            case DisplayOpSetFont:
+                st.CurFont = (Font*) cmd.Resource;
+                st.Known |= stateFont;
+                return;
+            case DisplayOpSetPen:
+                st.CurPen = (Pen*) cmd.Resource;
+                st.Known |= statePen;
+                return;
+            case DisplayOpSetBrush:
+                st.CurBrush = (Brush*) cmd.Resource;
+                st.Known |= stateBrush;
+                return;
+            case DisplayOpSetTextColor:
+                st.TextColor = cmd.Color;
+                st.Known |= stateTextColor;
+                return;
+            case DisplayOpSetTextBackColor:
+                st.BackOpaque = true;
+                st.BackColor = cmd.Color;
+                st.Known |= stateBackground;
+                return;
+            case DisplayOpSetTextBackTransparent:
+                st.BackOpaque = false;
+                st.Known |= stateBackground;
+                return;
+            case DisplayOpMoveTo:
+                _batchHasPos = true;
+                _batchPosX = cmd.Args[0];
+                _batchPosY = cmd.Args[1];
+                return;
+            case DisplayOpLineTo:
+            {
+                // Becomes a self-contained line, so that it can be reordered
+                if (!_batchHasPos)
+                    throw runtime_error("SketchpadHelper: LineDrawTo in a batch must follow a LineMoveTo in the same batch.");
+                DisplayCommand line = cmd;
+                line.Op = DisplayOpLine;
+                line.Args[0] = _batchPosX;
+                line.Args[1] = _batchPosY;
+                line.Args[2] = _batchPosX = cmd.Args[0];
+                line.Args[3] = _batchPosY = cmd.Args[1];
+                queue(line, NULL, NULL);
+                return;
+            }
+            default: // drawing commands are queued below
+                break;
+        }
+        batchEntry entry;
+        entry.State = st;
+        entry.IsText = cmd.Op == DisplayOpText || cmd.Op == DisplayOpTextBox;
+        entry.Command = (int) _batch->_commands.size();
+        _batch->add(cmd, points, text);
+        _batchEntries.push_back(entry);
+    }
+
+    // Shapes before text; shapes by pen and brush, and text by font and colors; otherwise in the order drawn
+    bool SketchpadHelper::batchOrder(const batchEntry& a, const batchEntry& b)
+    {
+        if (a.IsText != b.IsText)
+            return b.IsText;
+        const drawState &sa = a.State, &sb = b.State;
+        if (!a.IsText)
+        {
+            if (sa.CurPen != sb.CurPen)
+                return less<Pen*>()(sa.CurPen, sb.CurPen);
+            if (sa.CurBrush != sb.CurBrush)
+                return less<Brush*>()(sa.CurBrush, sb.CurBrush);
+        }
+        else
+        {
+            if (sa.CurFont != sb.CurFont)
+                return less<Font*>()(sa.CurFont, sb.CurFont);
+            if (sa.TextColor != sb.TextColor)
+                return sa.TextColor < sb.TextColor;
+            if (sa.BackOpaque != sb.BackOpaque)
+                return sb.BackOpaque;
+            if (sa.BackColor != sb.BackColor)
+                return sa.BackColor < sb.BackColor;
+        }
+        return a.Command < b.Command;
+    }
+
+    // Selects the parts of the given state listed in flags, if they're set in it
+    void SketchpadHelper::applyState(const drawState& state, unsigned flags)
+    {
+        flags &= state.Known;
+        if (flags & stateFont)
+            execute(makeCommand(DisplayOpSetFont, (void*) state.CurFont), NULL, NULL);
+        if (flags & statePen)
+            execute(makeCommand(DisplayOpSetPen, (void*) state.CurPen), NULL, NULL);
+        if (flags & stateBrush)
+            execute(makeCommand(DisplayOpSetBrush, (void*) state.CurBrush), NULL, NULL);
+        if (flags & stateTextColor)
+            execute(makeCommand(DisplayOpSetTextColor, state.TextColor), NULL, NULL);
+        if (flags & stateBackground)
+        {
+            if (state.BackOpaque)
+                execute(makeCommand(DisplayOpSetTextBackColor, state.BackColor), NULL, NULL);
+            else
+                execute(makeCommand(DisplayOpSetTextBackTransparent), NULL, NULL);
+        }
+    }
+
+    void SketchpadHelper::EndBatch()
+    {
+        if (!_batching)
+            throw runtime_error("SketchpadHelper: EndBatch called without a matching BeginBatch.");
+        _batching = false;
+
+        sort(_batchEntries.begin(), _batchEntries.end(), batchOrder);
+        for (size_t i = 0; i < _batchEntries.size(); i++)
+        {
+            const batchEntry& entry = _batchEntries[i];
+            const DisplayCommand& cmd = _batch->_commands[entry.Command];
+            if (entry.IsText)
+                applyState(entry.State, stateFont | stateTextColor | stateBackground);
+            else
+                applyState(entry.State, statePen | stateBrush);
+            execute(cmd, _batch->getPoints(cmd), _batch->getText(cmd));
+        }
+
+        // Leave everything as if the batch had been drawn directly
+        applyState(_batchState, ~0u);
+        if (_batchHasPos)
+            execute(makeCommand(DisplayOpMoveTo, _batchPosX, _batchPosY), NULL, NULL);
+        _batchEntries.clear();
+        _batch->begin(0, 0, 0, 0, 0);
+    }
+
+
+
     SketchpadHelper* SketchpadHelper::SetFont(Font* font)
     {
-        _sketchpad->SetFont(font);
+        issue(makeCommand(DisplayOpSetFont, (void*) font));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::SetFontProportional()
     {
-        _sketchpad->SetFont(GetFontProportional());
-        return this;
+        return SetFont(GetFontProportional());
     }
 
     SketchpadHelper* SketchpadHelper::SetFontMonospace()
     {
-        _sketchpad->SetFont(GetFontMonospace());
-        return this;
+        return SetFont(GetFontMonospace());
     }
 
     SketchpadHelper* SketchpadHelper::SetPen(Pen* pen)
     {
-        _sketchpad->SetPen(pen);
+        issue(makeCommand(DisplayOpSetPen, (void*) pen));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::SetPen(MfdColor color, bool dashed)
     {
-        _sketchpad->SetPen(GetPen(color, dashed));
-        return this;
+        return SetPen(GetPen(color, dashed));
     }
 
     SketchpadHelper* SketchpadHelper::SetPenInvisible()
     {
-        _sketchpad->SetPen(GetPenInvisible());
-        return this;
+        return SetPen(GetPenInvisible());
     }
 
     SketchpadHelper* SketchpadHelper::SetBrush(Brush* brush)
     {
-        _sketchpad->SetBrush(brush);
+        issue(makeCommand(DisplayOpSetBrush, (void*) brush));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::SetBrush(MfdColor color)
     {
-        _sketchpad->SetBrush(GetBrush(color));
-        return this;
+        return SetBrush(GetBrush(color));
     }
 
     SketchpadHelper* SketchpadHelper::SetTextColor(DWORD color)
     {
-        _sketchpad->SetTextColor(color);
+        issue(makeCommand(DisplayOpSetTextColor, color));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::SetTextColor(MfdColor color)
     {
-        _sketchpad->SetTextColor(MfdColorValue.FromEnum(color));
-        return this;
+        return SetTextColor(MfdColorValue.FromEnum(color));
     }
 
     SketchpadHelper* SketchpadHelper::SetTextBackColor(DWORD color)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
-        _sketchpad->SetBackgroundMode(oapi::Sketchpad::BK_OPAQUE);
-        _sketchpad->SetBackgroundColor(color);
-#else
-        _sketchpad->SetTextBackColor(color);
-#endif
+        issue(makeCommand(DisplayOpSetTextBackColor, color));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::SetTextBackColor(MfdColor color)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
-        _sketchpad->SetBackgroundMode(oapi::Sketchpad::BK_OPAQUE);
-        _sketchpad->SetBackgroundColor(MfdColorValue.FromEnum(color));
-#else
-        _sketchpad->SetTextBackColor(MfdColorValue.FromEnum(color));
-#endif
-        return this;
+        return SetTextBackColor(MfdColorValue.FromEnum(color));
     }
 
     SketchpadHelper* SketchpadHelper::SetTextBackTransparent()
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
-        _sketchpad->SetBackgroundMode(oapi::Sketchpad::BK_TRANSPARENT);
-#else
-        _sketchpad->SetTextBackTransparent();
-#endif
+        issue(makeCommand(DisplayOpSetTextBackTransparent));
         return this;
     }
 
@@ -513,81 +881,262 @@ namespace borb {
 
     SketchpadHelper* SketchpadHelper::LineMoveTo(double x, double y)
     {
-        _sketchpad->MoveTo(calcX(x), calcY(y));
+        issue(makeCommand(DisplayOpMoveTo, calcX(x), calcY(y)));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::LineDrawTo(double x, double y)
     {
-        _sketchpad->LineTo(calcX(x), calcY(y));
+        issue(makeCommand(DisplayOpLineTo, calcX(x), calcY(y)));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::DrawLine(double x1, double y1, double x2, double y2)
     {
-        _sketchpad->Line(calcX(x1), calcY(y1), calcX(x2), calcY(y2));
+        issue(makeCommand(DisplayOpLine, calcX(x1), calcY(y1), calcX(x2), calcY(y2)));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::DrawRectangle(double x1, double y1, double x2, double y2)
     {
-        _sketchpad->Rectangle(calcX(x1), calcY(y1), calcX(x2), calcY(y2));
+        issue(makeCommand(DisplayOpRectangle, calcX(x1), calcY(y1), calcX(x2), calcY(y2)));
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::DrawEllipse(double x1, double y1, double x2, double y2)
     {
-        _sketchpad->Ellipse(calcX(x1), calcY(y1), calcX(x2), calcY(y2));
+        issue(makeCommand(DisplayOpEllipse, calcX(x1), calcY(y1), calcX(x2), calcY(y2)));
         return this;
     }
 
-    void SketchpadHelper::calcXY(const vector<VECTOR2> src, vector<IVECTOR2>& dest)
+    // Transforms the points into the scratch buffer, which stays valid until the next call
+    const IVECTOR2* SketchpadHelper::calcXY(const VECTOR2* src, int count)
     {
-        dest.clear();
-        for (vector<VECTOR2>::const_iterator iter = src.begin(); iter != src.end(); iter++)
+        if ((int) _scratch.size() < count)
+            _scratch.resize(count);
+        IVECTOR2* dest = &_scratch[0];
+        int i = 0;
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+        // Same as calcX and calcY, for x and y at once: a VECTOR2 fills an SSE2 register, and a pair of truncated ints an IVECTOR2
+        __m128d origin = _mm_set_pd(_originY, _originX);
+        __m128d unit = _mm_set1_pd(_unitSize);
+        __m128d half = _mm_set1_pd(0.5);
+        for (; i < count; i++)
+        {
+            __m128d pt = _mm_loadu_pd(src[i].data);
+            pt = _mm_add_pd(_mm_mul_pd(_mm_add_pd(pt, origin), unit), half);
+            _mm_storel_epi64((__m128i*) &dest[i], _mm_cvttpd_epi32(pt));
+        }
+#endif
+        for (; i < count; i++)
         {
-            IVECTOR2 pt;
-            pt.x = calcX(iter->x);
-            pt.y = calcY(iter->y);
-            dest.push_back(pt);
+            dest[i].x = calcX(src[i].x);
+            dest[i].y = calcY(src[i].y);
         }
+        return dest;
     }
 
-    SketchpadHelper* SketchpadHelper::DrawPolygon(const vector<VECTOR2> points)
+    void SketchpadHelper::drawPoints(bool polygon, const VECTOR2* points, int count)
     {
-        vector<IVECTOR2> pts;
-        calcXY(points, pts);
-        _sketchpad->Polygon(&pts[0], pts.size());
+        if (count <= 0)
+            return;
+        if (!polygon && _simplify)
+        {
+            drawSimplified(points, count);
+            return;
+        }
+        DisplayCommand cmd = makeCommand(polygon ? DisplayOpPolygon : DisplayOpPolyline);
+        cmd.Count = count;
+        issue(cmd, calcXY(points, count));
+    }
+
+    // Clips the segment (x, y) + t * (dx, dy), 0 <= t <= 1, to the rectangle (Liang-Barsky). Returns false if it's
+    // entirely outside, otherwise the range of t inside.
+    static bool clipSegment(double x, double y, double dx, double dy, double xmin, double ymin, double xmax, double ymax, double& t0, double& t1)
+    {
+        double p[4] = { -dx, dx, -dy, dy };
+        double q[4] = { x - xmin, xmax - x, y - ymin, ymax - y };
+        t0 = 0;
+        t1 = 1;
+        for (int i = 0; i < 4; i++)
+        {
+            if (p[i] == 0)
+            {
+                if (q[i] < 0)
+                    return false; // parallel to this edge, and outside it
+                continue;
+            }
+            double t = q[i] / p[i];
+            if (p[i] < 0)
+            {
+                if (t > t1)
+                    return false;
+                if (t > t0)
+                    t0 = t;
+            }
+            else
+            {
+                if (t < t0)
+                    return false;
+                if (t < t1)
+                    t1 = t;
+            }
+        }
+        return true;
+    }
+
+    void SketchpadHelper::drawSimplified(const VECTOR2* points, int count)
+    {
+        // Clip in the helper's units, to the display plus a pixel all round. Segments that leave the display and come
+        // back split the polyline into separate runs.
+        double margin = 1 / _unitSize;
+        double xmin = -_originX - margin, xmax = _dispSize / _unitSize - _originX + margin;
+        double ymin = -_originY - margin, ymax = _dispSize / _unitSize - _originY + margin;
+        _clipped.clear();
+        _clipRuns.clear();
+        bool continues = false; // whether the last segment ended inside, so that the next one continues its run
+        for (int i = 0; i + 1 < count; i++)
+        {
+            const VECTOR2 &a = points[i], &b = points[i + 1];
+            double dx = b.x - a.x, dy = b.y - a.y, t0, t1;
+            if (!clipSegment(a.x, a.y, dx, dy, xmin, ymin, xmax, ymax, t0, t1))
+            {
+                continues = false;
+                continue;
+            }
+            VECTOR2 pt;
+            if (!continues || t0 > 0)
+            {
+                _clipRuns.push_back((int) _clipped.size());
+                pt.x = a.x + t0 * dx;
+                pt.y = a.y + t0 * dy;
+                _clipped.push_back(pt);
+            }
+            pt.x = t1 < 1 ? a.x + t1 * dx : b.x;
+            pt.y = t1 < 1 ? a.y + t1 * dy : b.y;
+            _clipped.push_back(pt);
+            continues = t1 >= 1;
+        }
+        if (_clipped.empty())
+            return;
+        _clipRuns.push_back((int) _clipped.size());
+
+        calcXY(&_clipped[0], (int) _clipped.size());
+        for (size_t r = 0; r + 1 < _clipRuns.size(); r++)
+        {
+            IVECTOR2* run = &_scratch[_clipRuns[r]];
+            DisplayCommand cmd = makeCommand(DisplayOpPolyline);
+            cmd.Count = simplify(run, _clipRuns[r + 1] - _clipRuns[r]);
+            if (cmd.Count >= 2)
+                issue(cmd, run);
+        }
+    }
+
+    // Simplifies the polyline in place, returning the number of points left
+    int SketchpadHelper::simplify(IVECTOR2* pts, int count)
+    {
+        // Drop repeated points, and points on the straight line between their neighbours
+        int n = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (n > 0 && pts[i].x == pts[n - 1].x && pts[i].y == pts[n - 1].y)
+                continue;
+            if (n >= 2)
+            {
+                long ax = pts[n - 1].x - pts[n - 2].x, ay = pts[n - 1].y - pts[n - 2].y;
+                long bx = pts[i].x - pts[n - 1].x, by = pts[i].y - pts[n - 1].y;
+                if (ax * by == ay * bx && ax * bx + ay * by > 0) // collinear, and not doubling back
+                    n--;
+            }
+            pts[n++] = pts[i];
+        }
+        if (n <= 2 || _simplifyTolerance <= 0)
+            return n;
+
+        // Douglas-Peucker, with an explicit stack of spans still to be simplified
+        double tol2 = _simplifyTolerance * _simplifyTolerance;
+        _keep.assign(n, 0);
+        _keep[0] = _keep[n - 1] = 1;
+        _spans.clear();
+        _spans.push_back(make_pair(0, n - 1));
+        while (!_spans.empty())
+        {
+            int first = _spans.back().first, last = _spans.back().second;
+            _spans.pop_back();
+            double dx = pts[last].x - pts[first].x, dy = pts[last].y - pts[first].y;
+            double len2 = dx * dx + dy * dy;
+            double worst = 0;
+            int worstIndex = -1;
+            for (int i = first + 1; i < last; i++)
+            {
+                double px = pts[i].x - pts[first].x, py = pts[i].y - pts[first].y;
+                double cross = dx * py - dy * px;
+                // squared distance from the line, times len2; or from the end point if the span is a closed loop
+                double dist = len2 > 0 ? cross * cross : px * px + py * py;
+                if (dist > worst)
+                {
+                    worst = dist;
+                    worstIndex = i;
+                }
+            }
+            if (worstIndex >= 0 && worst > tol2 * (len2 > 0 ? len2 : 1))
+            {
+                _keep[worstIndex] = 1;
+                _spans.push_back(make_pair(first, worstIndex));
+                _spans.push_back(make_pair(worstIndex, last));
+            }
+        }
+        int kept = 0;
+        for (int i = 0; i < n; i++)
+            if (_keep[i])
+                pts[kept++] = pts[i];
+        return kept;
+    }
+
+    SketchpadHelper* SketchpadHelper::SetPolylineSimplification(bool enabled, double tolerancePixels)
+    {
+        _simplify = enabled;
+        _simplifyTolerance = tolerancePixels;
+        return this;
+    }
+
+    SketchpadHelper* SketchpadHelper::DrawPolygon(const vector<VECTOR2>& points)
+    {
+        drawPoints(true, points.empty() ? NULL : &points[0], (int) points.size());
+        return this;
+    }
+
+    SketchpadHelper* SketchpadHelper::DrawPolygon(const VECTOR2* points, int count)
+    {
+        drawPoints(true, points, count);
+        return this;
+    }
+
+    SketchpadHelper* SketchpadHelper::DrawPolyline(const vector<VECTOR2>& points)
+    {
+        drawPoints(false, points.empty() ? NULL : &points[0], (int) points.size());
         return this;
     }
 
-    SketchpadHelper* SketchpadHelper::DrawPolyline(const vector<VECTOR2> points)
+    SketchpadHelper* SketchpadHelper::DrawPolyline(const VECTOR2* points, int count)
     {
-        vector<IVECTOR2> pts;
-        calcXY(points, pts);
-        _sketchpad->Polygon(&pts[0], pts.size());
+        drawPoints(false, points, count);
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::DrawTextLine(double x, double y, const string& text, HORZALIGN horzAlign, VERTALIGN vertAlign)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
-        _sketchpad->SetTextAlign((oapi::Sketchpad::TAlign_horizontal) horzAlign, (oapi::Sketchpad::TAlign_vertical) vertAlign);
-        _sketchpad->Text(calcX(x), calcY(y), text.c_str(), text.size());
-#else
-        _sketchpad->Text(calcX(x), calcY(y), text, horzAlign, vertAlign);
-#endif
+        DisplayCommand cmd = makeCommand(DisplayOpText, calcX(x), calcY(y), horzAlign, vertAlign);
+        cmd.Count = text.size();
+        issue(cmd, NULL, text.c_str());
         return this;
     }
 
     SketchpadHelper* SketchpadHelper::DrawTextBox(double x1, double y1, double x2, double y2, const string& text)
     {
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
-        _sketchpad->SetTextAlign(oapi::Sketchpad::LEFT, oapi::Sketchpad::TOP);
-        _sketchpad->TextBox(calcX(x1), calcY(y1), calcX(x2), calcY(y2), text.c_str(), text.size());
-#else
-        _sketchpad->TextBox(calcX(x1), calcY(y1), calcX(x2), calcY(y2), text);
-#endif
+        DisplayCommand cmd = makeCommand(DisplayOpTextBox, calcX(x1), calcY(y1), calcX(x2), calcY(y2));
+        cmd.Count = text.size();
+        issue(cmd, NULL, text.c_str());
         return this;
     }
 
@@ -7,7 +7,7 @@
 
 #include <PrecompiledBoostOrbiter.h>
 
-#include "Misc.h"
+#include "Vector2.h"
 #include "MfdColors.h"
 
 namespace borb {
@@ -41,7 +41,14 @@ namespace borb {
 		VA_BOTTOM = 2
 	};
 
-#ifdef USE_ORBITERSDK_2010P1_OR_HIGHER
+    // The helper draws on Orbiter's own Sketchpad in Orbiter 2010 P1 and later, and on a wrapper around GDI with the
+    // same interface otherwise. The headless build (Headless/CMakeLists.txt) defines BORB_SOFTWARE_SKETCHPAD, which
+    // replaces either with the in-memory raster Sketchpad of SoftwareSketchpad.h, needing neither Orbiter nor GDI.
+#if defined(USE_ORBITERSDK_2010P1_OR_HIGHER) && !defined(BORB_SOFTWARE_SKETCHPAD)
+#  define BORB_OAPI_SKETCHPAD
+#endif
+
+#ifdef BORB_OAPI_SKETCHPAD
 
     typedef ::oapi::Sketchpad Sketchpad;
     typedef ::oapi::Brush Brush;
@@ -56,15 +63,19 @@ namespace borb {
     class Pen;
     class Font;
 
+    // The coordinates are ints rather than oapi's longs, so that they are 32-bit like a GDI POINT on every platform,
+    // including the 64-bit Unix ones the headless build runs on
     union IVECTOR2
     {
-	    long data[2];
-	    struct { long x, y; };
+	    int data[2];
+	    struct { int x, y; };
         IVECTOR2() { x = 0; y = 0; }
-        IVECTOR2(long x_, long y_) { x = x_; y = y_; }
+        IVECTOR2(int x_, int y_) { x = x_; y = y_; }
     };
 
+#ifndef BORB_SOFTWARE_SKETCHPAD
     std::shared_ptr<Sketchpad> GetSketchpad(HDC hDC);
+#endif
 
 #endif
 
@@ -75,11 +86,19 @@ namespace borb {
     Font* CreateFont(int height, bool proportional, const std::string& family, FONTSTYLE style, int orientation);
     void ReleaseFont(Font* font);
 
+    class DisplayList;
+    struct DisplayCommand;
+
     class SketchpadHelper
     {
     public:
         SketchpadHelper(Sketchpad* sketchpad, int width, int height);
 
+        // Starts drawing on another Sketchpad, e.g. for the next frame. Everything is reset as in the constructor, but
+        // the helper keeps its memory and, if the size is unchanged, the resources it has looked up.
+        void Attach(Sketchpad* sketchpad, int width, int height);
+
+        // These create a new resource, owned by the caller. The Get* methods below return shared ones from SketchpadResources.
         std::shared_ptr<Font> MakeFont(double height, bool proportional, const std::string& typeface, FONTSTYLE style = FONT_NORMAL, int orientation = 0);
         std::shared_ptr<Pen> MakePen(PENSTYLE style, double width, DWORD color); // Use width=0 for the thinnest possible. 0.003 is approx the width of a pixel line on an "average size" MFD.
         std::shared_ptr<Brush> MakeBrush(DWORD color);
@@ -112,12 +131,35 @@ namespace borb {
         SketchpadHelper* DrawLine(double x1, double y1, double x2, double y2);
         SketchpadHelper* DrawRectangle(double x1, double y1, double x2, double y2);
         SketchpadHelper* DrawEllipse(double x1, double y1, double x2, double y2);
-        SketchpadHelper* DrawPolygon(const std::vector<VECTOR2> points);
-        SketchpadHelper* DrawPolyline(const std::vector<VECTOR2> points);
+        SketchpadHelper* DrawPolygon(const std::vector<VECTOR2>& points);
+        SketchpadHelper* DrawPolygon(const VECTOR2* points, int count);
+        SketchpadHelper* DrawPolyline(const std::vector<VECTOR2>& points);
+        SketchpadHelper* DrawPolyline(const VECTOR2* points, int count);
+        // When enabled, polylines are clipped to the display, and points that make no visible difference are dropped
+        // before drawing: repeated and collinear points after rounding to pixels, and then any point within the
+        // tolerance (in pixels) of the simplified line (Douglas-Peucker). Meant for long plots and trajectories.
+        SketchpadHelper* SetPolylineSimplification(bool enabled, double tolerancePixels = 0.5);
         SketchpadHelper* DrawTextLine(double x, double y, const std::string& text, HORZALIGN horzAlign = HA_LEFT, VERTALIGN vertAlign = VA_TOP);
         SketchpadHelper* DrawTextBox(double x1, double y1, double x2, double y2, const std::string& text);
 
         inline double CalcButtonY(int numButton) { return 3.1 + 2.85*numButton; }
+        // The width of a pixel in the helper's units.
+        inline double GetPixelSize() { return 1.0 / _unitSize; }
+
+        // Starts a section of the page that is drawn through a DisplayList. If the list holds a recording of this
+        // section with the same hash, it's replayed and this returns false: skip the drawing code. Otherwise this
+        // returns true, and everything drawn until EndSection is recorded as well as drawn. The hash should identify
+        // everything the section's content depends on; use DisplayList::Invalidate to force a redraw regardless.
+        bool BeginSection(DisplayList& list, size_t hash);
+        // Ends the section being recorded. Only call this if BeginSection returned true.
+        void EndSection();
+
+        // Queues everything drawn until EndBatch, and then draws it ordered so as to minimise changes of pen, brush,
+        // font and colors: shapes first, grouped by pen and brush, then text, grouped by font and colors. This changes
+        // the order in which things are drawn, so only batch content where the order of overlapping items doesn't
+        // matter. A LineDrawTo in a batch must follow a LineMoveTo in the same batch.
+        void BeginBatch();
+        void EndBatch();
 
     private:
         Sketchpad* _sketchpad; // the underlying Sketchpad that all operations are performed on.
@@ -126,15 +168,69 @@ namespace borb {
         double _unitSize; // number of pixels per 1.0 of the logical units used by the helper.
         double _originX, _originY;
 
+        // The standard resources used so far, as obtained from SketchpadResources, to save a lookup on every use
         std::vector<std::shared_ptr<Pen>> _pensStdSolid, _pensStdDashed;
         std::vector<std::shared_ptr<Brush>> _brushesStd;
         std::shared_ptr<Pen> _penInvisible;
         std::shared_ptr<Font> _fontProportional, _fontMonospace;
+        int _resourceGeneration; // the SketchpadResources generation the above were obtained in
+
+        std::vector<IVECTOR2> _scratch; // transformed points, reused from call to call
+
+        // Polyline simplification, and the buffers it reuses from call to call
+        bool _simplify;
+        double _simplifyTolerance;
+        std::vector<VECTOR2> _clipped; // the clipped polyline, as a series of runs
+        std::vector<int> _clipRuns; // the index in _clipped where each run starts, and one past the end of the last
+        std::vector<char> _keep;
+        std::vector<std::pair<int, int>> _spans;
+
+        DisplayList* _recording; // the list being recorded into, or NULL if none
+
+        // The drawing state, tracked so that changes to the current state can be skipped
+        enum { stateFont = 1, statePen = 2, stateBrush = 4, stateTextColor = 8, stateBackground = 16, stateAlign = 32 };
+        struct drawState
+        {
+            unsigned Known; // a combination of the state* flags for the fields below that are set
+            Font* CurFont;
+            Pen* CurPen;
+            Brush* CurBrush;
+            DWORD TextColor, BackColor;
+            bool BackOpaque;
+            int HorzAlign, VertAlign;
+        };
+        drawState _state; // what is currently selected into the Sketchpad
+        unsigned _releasedResources; // the count of released resources as of the last check, see changeResource
+
+        // Batching
+        struct batchEntry
+        {
+            drawState State; // the state the command was drawn with
+            bool IsText;
+            int Command; // index in _batch
+        };
+        bool _batching;
+        std::shared_ptr<DisplayList> _batch; // the queued commands, with their points and text
+        std::vector<batchEntry> _batchEntries;
+        drawState _batchState; // the state as last set by the caller, which _state lags behind during a batch
+        bool _batchHasPos;
+        int _batchPosX, _batchPosY; // the line position set by the last LineMoveTo or LineDrawTo in the batch
 
         inline int calcX(double x) { return (int) ((_originX + x) * _unitSize + 0.5); }
         inline int calcY(double y) { return (int) ((_originY + y) * _unitSize + 0.5); }
         inline int calcFontHeight(double height) { return (int) ceil(height * _unitSize + 0.3 /* fudge factor */); }
-        void calcXY(const std::vector<VECTOR2> src, std::vector<IVECTOR2>& dest);
+        const IVECTOR2* calcXY(const VECTOR2* src, int count);
+        void drawPoints(bool polygon, const VECTOR2* points, int count);
+        void drawSimplified(const VECTOR2* points, int count);
+        int simplify(IVECTOR2* points, int count);
+        void issue(const DisplayCommand& cmd, const IVECTOR2* points = NULL, const char* text = NULL);
+        void dispatch(const DisplayCommand& cmd, const IVECTOR2* points, const char* text);
+        void execute(const DisplayCommand& cmd, const IVECTOR2* points, const char* text);
+        bool changeState(unsigned flag, bool same);
+        bool changeResource(unsigned flag, bool same);
+        void applyState(const drawState& state, unsigned flags);
+        void queue(const DisplayCommand& cmd, const IVECTOR2* points, const char* text);
+        static bool batchOrder(const batchEntry& a, const batchEntry& b);
     };
 
 }
@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "SketchpadResources.h"
+
+namespace borb {
+
+    using namespace std;
+
+    SketchpadResourceCache SketchpadResources;
+
+    bool SketchpadResourceCache::penKey::operator<(const penKey& other) const
+    {
+        if (Style != other.Style)
+            return Style < other.Style;
+        if (Width != other.Width)
+            return Width < other.Width;
+        return Color < other.Color;
+    }
+
+    bool SketchpadResourceCache::fontKey::operator<(const fontKey& other) const
+    {
+        if (Height != other.Height)
+            return Height < other.Height;
+        if (Proportional != other.Proportional)
+            return Proportional < other.Proportional;
+        if (Style != other.Style)
+            return Style < other.Style;
+        if (Orientation != other.Orientation)
+            return Orientation < other.Orientation;
+        return Typeface < other.Typeface;
+    }
+
+    shared_ptr<Pen> SketchpadResourceCache::GetPen(PENSTYLE style, int width, DWORD color)
+    {
+        penKey key = { style, width, color };
+        shared_ptr<Pen>& pen = _pens[key];
+        if (!pen)
+            pen = shared_ptr<Pen>(borb::CreatePen(style, width, color), borb::ReleasePen);
+        return pen;
+    }
+
+    shared_ptr<Brush> SketchpadResourceCache::GetBrush(DWORD color)
+    {
+        shared_ptr<Brush>& brush = _brushes[color];
+        if (!brush)
+            brush = shared_ptr<Brush>(borb::CreateBrush(color), borb::ReleaseBrush);
+        return brush;
+    }
+
+    shared_ptr<Font> SketchpadResourceCache::GetFont(int height, bool proportional, const string& typeface, FONTSTYLE style, int orientation)
+    {
+        fontKey key = { height, proportional, typeface, style, orientation };
+        shared_ptr<Font>& font = _fonts[key];
+        if (!font)
+            font = shared_ptr<Font>(borb::CreateFont(height, proportional, typeface, style, orientation), borb::ReleaseFont);
+        return font;
+    }
+
+    void SketchpadResourceCache::Clear()
+    {
+        _pens.clear();
+        _brushes.clear();
+        _fonts.clear();
+        _generation++;
+    }
+
+}
@@ -0,0 +1,63 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "SketchpadHelper.h"
+
+namespace borb {
+
+    // Pens, brushes and fonts shared by every SketchpadHelper in the process, so that MFDs don't create and release
+    // their GDI / oapi objects on every redraw. Resources are keyed by their parameters in pixels, which already
+    // reflect the size of the MFD they were requested for, so MFDs of the same size share them and MFDs of different
+    // sizes get their own. The cache and every helper hold shared pointers, so a resource is released once the cache
+    // has been cleared and the last helper using it is gone. Module.cpp.h clears the cache in opcCloseRenderViewport.
+    // Not thread-safe: use it from the thread that draws the MFDs.
+    class SketchpadResourceCache : private boost::noncopyable
+    {
+    public:
+        SketchpadResourceCache() : _generation(0) { }
+
+        std::shared_ptr<Pen> GetPen(PENSTYLE style, int width, DWORD color);
+        std::shared_ptr<Brush> GetBrush(DWORD color);
+        std::shared_ptr<Font> GetFont(int height, bool proportional, const std::string& typeface, FONTSTYLE style = FONT_NORMAL, int orientation = 0);
+
+        // The number of resources currently held by the cache.
+        int GetCount() { return (int) (_pens.size() + _brushes.size() + _fonts.size()); }
+        // Drops the cache's references to every resource.
+        void Clear();
+        // Incremented by every Clear, so that anything holding raw pointers to cached resources can tell they may be gone.
+        int GetGeneration() { return _generation; }
+
+    private:
+        struct penKey
+        {
+            PENSTYLE Style;
+            int Width;
+            DWORD Color;
+            bool operator<(const penKey& other) const;
+        };
+        struct fontKey
+        {
+            int Height;
+            bool Proportional;
+            std::string Typeface;
+            FONTSTYLE Style;
+            int Orientation;
+            bool operator<(const fontKey& other) const;
+        };
+
+        int _generation;
+        std::map<penKey, std::shared_ptr<Pen>> _pens;
+        std::map<DWORD, std::shared_ptr<Brush>> _brushes;
+        std::map<fontKey, std::shared_ptr<Font>> _fonts;
+    };
+
+    // The cache used by SketchpadHelper for its standard pens, brushes and fonts.
+    extern SketchpadResourceCache SketchpadResources;
+
+}
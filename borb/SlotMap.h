@@ -0,0 +1,329 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include <type_traits>
+
+namespace borb {
+
+    // Identifies a value stored in a SlotMap. A handle remains valid until its value is removed; after that the
+    // generation no longer matches, so the handle is reliably recognised as stale even once its slot is reused.
+    struct SlotHandle
+    {
+        unsigned Index, Generation;
+
+        // Constructs a null handle, which never refers to any value.
+        SlotHandle() : Index(0), Generation(0) { }
+        SlotHandle(unsigned index, unsigned generation) : Index(index), Generation(generation) { }
+
+        bool IsNull() const { return Generation == 0; }
+        bool operator==(const SlotHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+        bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+    };
+
+    // Stores values contiguously, for fast iteration, while handing out handles that stay valid as other values are
+    // added and removed. Insertion, removal and lookup by handle are all O(1). Removal moves the last value into the
+    // gap, so it changes the iteration order and invalidates iterators and pointers to values.
+    template<class T>
+    class SlotMap
+    {
+    public:
+        typedef typename std::vector<T>::iterator iterator;
+
+        SlotMap() : _freeHead(noSlot) { }
+
+        iterator begin() { return _values.begin(); }
+        iterator end() { return _values.end(); }
+        size_t size() const { return _values.size(); }
+        bool empty() const { return _values.empty(); }
+
+        // Adds a copy of the value and returns its handle.
+        SlotHandle Insert(const T& value)
+        {
+            unsigned index;
+            if (_freeHead != noSlot)
+            {
+                index = _freeHead;
+                _freeHead = _slots[index].Dense;
+            }
+            else
+            {
+                index = (unsigned) _slots.size();
+                _slots.push_back(slot(1));
+            }
+            _slots[index].Dense = (unsigned) _values.size();
+            _values.push_back(value);
+            _valueSlots.push_back(index);
+            return SlotHandle(index, _slots[index].Generation);
+        }
+
+        // Returns the value with this handle, or NULL if the handle is null or its value has been removed.
+        T* Get(SlotHandle handle)
+        {
+            if (handle.Index >= _slots.size() || _slots[handle.Index].Generation != handle.Generation)
+                return NULL;
+            return &_values[_slots[handle.Index].Dense];
+        }
+
+        // Returns the handle of the value at the specified position in iteration order.
+        SlotHandle GetHandleAt(size_t position)
+        {
+            unsigned index = _valueSlots[position];
+            return SlotHandle(index, _slots[index].Generation);
+        }
+
+        // Removes the value with this handle. Returns false if there was no such value.
+        bool Remove(SlotHandle handle)
+        {
+            if (Get(handle) == NULL)
+                return false;
+            unsigned dense = _slots[handle.Index].Dense;
+            unsigned last = (unsigned) _values.size() - 1;
+            if (dense != last)
+            {
+                _values[dense] = _values[last];
+                _valueSlots[dense] = _valueSlots[last];
+                _slots[_valueSlots[dense]].Dense = dense;
+            }
+            _values.pop_back();
+            _valueSlots.pop_back();
+            release(handle.Index);
+            return true;
+        }
+
+        // Like Remove, but shifts the later values down instead of moving the last one into the gap, so the remaining
+        // values keep their iteration order. Linear in the number of values.
+        bool RemoveStable(SlotHandle handle)
+        {
+            if (Get(handle) == NULL)
+                return false;
+            unsigned dense = _slots[handle.Index].Dense;
+            _values.erase(_values.begin() + dense);
+            _valueSlots.erase(_valueSlots.begin() + dense);
+            for (unsigned i = dense; i < (unsigned) _valueSlots.size(); i++)
+                _slots[_valueSlots[i]].Dense = i;
+            release(handle.Index);
+            return true;
+        }
+
+        // Removes all values; every handle issued so far becomes stale.
+        void clear()
+        {
+            for (size_t i = 0; i < _valueSlots.size(); i++)
+                release(_valueSlots[i]);
+            _values.clear();
+            _valueSlots.clear();
+        }
+
+    private:
+        enum { noSlot = 0xFFFFFFFF };
+
+        struct slot
+        {
+            unsigned Dense; // position of the value in _values; for a free slot, the index of the next free slot
+            unsigned Generation;
+            slot(unsigned generation) : Dense(0), Generation(generation) { }
+        };
+
+        std::vector<T> _values;
+        std::vector<unsigned> _valueSlots; // the slot of each value in _values
+        std::vector<slot> _slots;
+        unsigned _freeHead;
+
+        void release(unsigned index)
+        {
+            _slots[index].Generation++;
+            if (_slots[index].Generation == 0) // 0 is reserved for null handles
+                _slots[index].Generation = 1;
+            _slots[index].Dense = _freeHead;
+            _freeHead = index;
+        }
+    };
+
+    // Allocates objects of type T in chunks of contiguous storage, reusing the space of destroyed objects. Objects are
+    // constructed in place and never moved, so T needn't be copyable, and pointers to them stay valid until they're
+    // destroyed. The pool doesn't track which objects are alive: the owner must Destroy every object before the pool
+    // goes away.
+    template<class T>
+    class ObjectPool : boost::noncopyable
+    {
+    public:
+        ObjectPool() : _free(NULL) { }
+
+        ~ObjectPool()
+        {
+            for (size_t i = 0; i < _chunks.size(); i++)
+                delete[] _chunks[i];
+        }
+
+        // Constructs a T from the argument.
+        template<class TArg>
+        T* Create(TArg arg)
+        {
+            if (_free == NULL)
+                grow();
+            node* n = _free;
+            _free = n->Next;
+            try
+            {
+                return new (&n->Storage) T(arg);
+            }
+            catch (...)
+            {
+                n->Next = _free;
+                _free = n;
+                throw;
+            }
+        }
+
+        void Destroy(T* value)
+        {
+            value->~T();
+            node* n = reinterpret_cast<node*>(value);
+            n->Next = _free;
+            _free = n;
+        }
+
+    private:
+        enum { chunkSize = 32 };
+
+        union node
+        {
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type Storage;
+            node* Next; // while the node is free
+        };
+
+        std::vector<node*> _chunks;
+        node* _free;
+
+        void grow()
+        {
+            node* chunk = new node[chunkSize];
+            _chunks.push_back(chunk);
+            for (int i = chunkSize - 1; i >= 0; i--)
+            {
+                chunk[i].Next = _free;
+                _free = &chunk[i];
+            }
+        }
+    };
+
+    // A hash map from pointers to small values, stored in a single flat array with linear probing, so a lookup usually
+    // touches a single cache line. NULL cannot be used as a key. Removal shifts later entries back instead of leaving
+    // tombstones, so the map doesn't degrade as entries come and go.
+    template<class TKey, class TValue>
+    class FlatPointerMap
+    {
+    public:
+        FlatPointerMap() : _count(0) { }
+
+        size_t Count() const { return _count; }
+
+        // Returns the value for this key, or NULL if the key is not in the map.
+        TValue* Find(TKey* key)
+        {
+            if (_count == 0)
+                return NULL;
+            for (size_t i = home(key); ; i = (i + 1) & mask())
+            {
+                if (_entries[i].Key == key)
+                    return &_entries[i].Value;
+                if (_entries[i].Key == NULL)
+                    return NULL;
+            }
+        }
+
+        // Adds the key or replaces its value.
+        void Set(TKey* key, const TValue& value)
+        {
+            if ((_count + 1) * 4 > _entries.size() * 3) // keep the load factor under 75%
+                grow();
+            for (size_t i = home(key); ; i = (i + 1) & mask())
+            {
+                if (_entries[i].Key == NULL)
+                {
+                    _entries[i].Key = key;
+                    _entries[i].Value = value;
+                    _count++;
+                    return;
+                }
+                if (_entries[i].Key == key)
+                {
+                    _entries[i].Value = value;
+                    return;
+                }
+            }
+        }
+
+        // Removes the key. Returns false if it wasn't in the map.
+        bool Remove(TKey* key)
+        {
+            if (_count == 0)
+                return false;
+            size_t i = home(key);
+            while (_entries[i].Key != key)
+            {
+                if (_entries[i].Key == NULL)
+                    return false;
+                i = (i + 1) & mask();
+            }
+            // Move back any following entries that would otherwise become unreachable across the new gap
+            for (size_t j = (i + 1) & mask(); _entries[j].Key != NULL; j = (j + 1) & mask())
+            {
+                size_t h = home(_entries[j].Key);
+                if (((j - h) & mask()) >= ((j - i) & mask()))
+                {
+                    _entries[i] = _entries[j];
+                    i = j;
+                }
+            }
+            _entries[i].Key = NULL;
+            _count--;
+            return true;
+        }
+
+        void Clear()
+        {
+            for (size_t i = 0; i < _entries.size(); i++)
+                _entries[i].Key = NULL;
+            _count = 0;
+        }
+
+    private:
+        struct entry
+        {
+            TKey* Key;
+            TValue Value;
+            entry() : Key(NULL), Value() { }
+        };
+
+        std::vector<entry> _entries; // the size is always zero or a power of two
+        size_t _count;
+
+        size_t mask() const { return _entries.size() - 1; }
+
+        size_t home(TKey* key) const
+        {
+            // Fibonacci hashing; the low bits of a pointer are mostly zero due to alignment, so use the high bits of the product
+            unsigned hash = (unsigned) (((size_t) key >> 3) * 2654435769u);
+            return (hash >> 16 | hash << 16) & mask();
+        }
+
+        void grow()
+        {
+            std::vector<entry> old;
+            old.swap(_entries);
+            _entries.resize(old.empty() ? 16 : old.size() * 2);
+            _count = 0;
+            for (size_t i = 0; i < old.size(); i++)
+                if (old[i].Key != NULL)
+                    Set(old[i].Key, old[i].Value);
+        }
+    };
+
+}
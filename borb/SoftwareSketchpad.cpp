@@ -0,0 +1,386 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "SoftwareSketchpad.h"
+
+#ifdef BORB_SOFTWARE_SKETCHPAD
+
+#include <fstream>
+
+namespace borb {
+
+    using namespace std;
+
+    // The classic 5x7 font, for characters 32 to 126: five columns per character, the least significant bit at the
+    // top. Bit 7 is the row below the baseline, used by descenders.
+    static const unsigned char fontGlyphs[95][5] = {
+        {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14}, // space ! " #
+        {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00}, // $ % & '
+        {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08}, // ( ) * +
+        {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02}, // , - . /
+        {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33}, // 0 1 2 3
+        {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07}, // 4 5 6 7
+        {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00}, // 8 9 : ;
+        {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06}, // < = > ?
+        {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22}, // @ A B C
+        {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73}, // D E F G
+        {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, // H I J K
+        {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E}, // L M N O
+        {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32}, // P Q R S
+        {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F}, // T U V W
+        {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41}, // X Y Z [
+        {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40}, // \ ] ^ _
+        {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28}, // ` a b c
+        {0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78}, // d e f g
+        {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00}, // h i j k
+        {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38}, // l m n o
+        {0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24}, // p q r s
+        {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C}, // t u v w
+        {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00}, // x y z {
+        {0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},                             // | } ~
+    };
+    static const int glyphCellWidth = 6, glyphCellHeight = 8, glyphBaseline = 7; // in font pixels, before scaling
+
+
+
+    Sketchpad::Sketchpad(int width, int height)
+    {
+        if (width <= 0 || height <= 0)
+            throw runtime_error("Sketchpad: the size must be positive.");
+        _width = width;
+        _height = height;
+        _pixels.resize(width * height);
+        Clear();
+        _posX = _posY = 0;
+        _penVisible = _brushVisible = false;
+        _penStyle = PEN_SOLID;
+        _penWidth = 1;
+        _penColor = _brushColor = 0;
+        _fontScale = 1;
+        _fontStyle = FONT_NORMAL;
+        _textColor = 0;
+        _backColor = 0xFFFFFF;
+        _backOpaque = true; // as in GDI
+        _dashPhase = 0;
+    }
+
+    void Sketchpad::Clear(DWORD color)
+    {
+        fill(_pixels.begin(), _pixels.end(), color | 0xFF000000);
+    }
+
+    bool Sketchpad::SavePPM(const string& filename)
+    {
+        ofstream file(filename.c_str(), ios::binary);
+        if (!file)
+            return false;
+        file << "P6\n" << _width << " " << _height << "\n255\n";
+        vector<char> row(_width * 3);
+        for (int y = 0; y < _height; y++)
+        {
+            for (int x = 0; x < _width; x++)
+            {
+                DWORD c = _pixels[y * _width + x];
+                row[x * 3] = (char) (c & 0xFF);
+                row[x * 3 + 1] = (char) ((c >> 8) & 0xFF);
+                row[x * 3 + 2] = (char) ((c >> 16) & 0xFF);
+            }
+            file.write(&row[0], row.size());
+        }
+        return file.good();
+    }
+
+    int Sketchpad::ComparePPM(const string& filename)
+    {
+        ifstream file(filename.c_str(), ios::binary);
+        string magic;
+        int width, height, maxval;
+        file >> magic >> width >> height >> maxval;
+        if (!file || magic != "P6" || width != _width || height != _height || maxval != 255)
+            return -1;
+        file.get(); // the single whitespace character before the pixels
+        vector<char> row(_width * 3);
+        int differences = 0;
+        for (int y = 0; y < _height; y++)
+        {
+            if (!file.read(&row[0], row.size()))
+                return -1;
+            for (int x = 0; x < _width; x++)
+            {
+                DWORD c = (unsigned char) row[x * 3] | ((unsigned char) row[x * 3 + 1] << 8) | ((unsigned char) row[x * 3 + 2] << 16);
+                if (c != (_pixels[y * _width + x] & 0xFFFFFF))
+                    differences++;
+            }
+        }
+        return differences;
+    }
+
+
+
+    void Sketchpad::SetFont(Font* font)
+    {
+        int height = font == NULL ? glyphCellHeight : abs(font->Height);
+        _fontScale = max(1, (height + glyphCellHeight / 2) / glyphCellHeight);
+        _fontStyle = font == NULL ? FONT_NORMAL : font->Style;
+    }
+
+    void Sketchpad::SetPen(Pen* pen)
+    {
+        _penVisible = pen != NULL && pen->Style != PEN_INVISIBLE;
+        if (pen != NULL)
+        {
+            _penStyle = pen->Style;
+            _penWidth = max(1, pen->Width);
+            _penColor = pen->Color;
+        }
+    }
+
+    void Sketchpad::SetBrush(Brush* brush)
+    {
+        _brushVisible = brush != NULL;
+        if (brush != NULL)
+            _brushColor = brush->Color;
+    }
+
+
+
+    void Sketchpad::fillSpan(int y, int x1, int x2, DWORD color)
+    {
+        if (y < 0 || y >= _height)
+            return;
+        x1 = max(x1, 0);
+        x2 = min(x2, _width);
+        DWORD* row = &_pixels[y * _width];
+        for (int x = x1; x < x2; x++)
+            row[x] = color | 0xFF000000;
+    }
+
+    void Sketchpad::fillRect(int x1, int y1, int x2, int y2, DWORD color)
+    {
+        for (int y = y1; y < y2; y++)
+            fillSpan(y, x1, x2, color);
+    }
+
+    void Sketchpad::penDot(int x, int y)
+    {
+        if (_penWidth <= 1)
+            plot(x, y, _penColor);
+        else
+            fillRect(x - _penWidth / 2, y - _penWidth / 2, x - _penWidth / 2 + _penWidth, y - _penWidth / 2 + _penWidth, _penColor);
+    }
+
+    // Bresenham's line. Dashed pens draw alternate runs of 2 pixels.
+    void Sketchpad::penLine(int x1, int y1, int x2, int y2)
+    {
+        if (!_penVisible)
+            return;
+        int dx = abs(x2 - x1), dy = -abs(y2 - y1);
+        int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+        int err = dx + dy;
+        int x = x1, y = y1;
+        while (x != x2 || y != y2)
+        {
+            if (_penStyle != PEN_DASHED || ((_dashPhase++ >> 1) & 1) == 0)
+                penDot(x, y);
+            int e2 = 2 * err;
+            if (e2 >= dy)
+            {
+                err += dy;
+                x += sx;
+            }
+            if (e2 <= dx)
+            {
+                err += dx;
+                y += sy;
+            }
+        }
+    }
+
+    void Sketchpad::LineTo(int x, int y)
+    {
+        penLine(_posX, _posY, x, y);
+        _posX = x;
+        _posY = y;
+    }
+
+    void Sketchpad::Line(int x1, int y1, int x2, int y2)
+    {
+        MoveTo(x1, y1);
+        LineTo(x2, y2);
+    }
+
+    void Sketchpad::Rectangle(int x1, int y1, int x2, int y2)
+    {
+        if (x2 < x1)
+            swap(x1, x2);
+        if (y2 < y1)
+            swap(y1, y2);
+        if (x2 - x1 < 1 || y2 - y1 < 1)
+            return;
+        if (_brushVisible)
+            fillRect(x1, y1, x2, y2, _brushColor);
+        penLine(x1, y1, x2 - 1, y1);
+        penLine(x2 - 1, y1, x2 - 1, y2 - 1);
+        penLine(x2 - 1, y2 - 1, x1, y2 - 1);
+        penLine(x1, y2 - 1, x1, y1);
+        if (x2 - x1 == 1 && y2 - y1 == 1 && _penVisible)
+            penDot(x1, y1); // a closed loop of zero-length lines draws nothing
+    }
+
+    void Sketchpad::Ellipse(int x1, int y1, int x2, int y2)
+    {
+        if (x2 < x1)
+            swap(x1, x2);
+        if (y2 < y1)
+            swap(y1, y2);
+        int rows = y2 - y1;
+        if (x2 - x1 < 1 || rows < 1)
+            return;
+
+        // The span of pixel centres inside the ellipse on each row, inclusive
+        double cx = (x1 + x2 - 1) / 2.0, cy = (y1 + y2 - 1) / 2.0, rx = (x2 - x1) / 2.0, ry = rows / 2.0;
+        vector<int> left(rows), right(rows);
+        for (int i = 0; i < rows; i++)
+        {
+            double v = (y1 + i - cy) / ry;
+            double hw = rx * sqrt(max(0.0, 1 - v * v));
+            left[i] = (int) ceil(cx - hw);
+            right[i] = (int) floor(cx + hw);
+        }
+        for (int i = 0; i < rows; i++)
+        {
+            int y = y1 + i;
+            if (_brushVisible)
+                fillSpan(y, left[i], right[i] + 1, _brushColor);
+            if (!_penVisible)
+                continue;
+            // The outline: pixels with a 4-neighbour outside the ellipse
+            for (int x = left[i]; x <= right[i]; x++)
+            {
+                bool border = x == left[i] || x == right[i] || i == 0 || i == rows - 1
+                    || x < left[i - 1] || x > right[i - 1] || x < left[i + 1] || x > right[i + 1];
+                if (border)
+                    penDot(x, y);
+            }
+        }
+    }
+
+    void Sketchpad::Polygon(const IVECTOR2* pts, int count)
+    {
+        if (count < 2)
+            return;
+        if (_brushVisible && count >= 3)
+        {
+            // Scanline fill at pixel centres, alternate (even-odd) rule
+            int ymin = pts[0].y, ymax = pts[0].y;
+            for (int i = 1; i < count; i++)
+            {
+                ymin = min(ymin, (int) pts[i].y);
+                ymax = max(ymax, (int) pts[i].y);
+            }
+            ymin = max(ymin, 0);
+            ymax = min(ymax, _height);
+            vector<double> crossings;
+            for (int y = ymin; y < ymax; y++)
+            {
+                double yc = y + 0.5;
+                crossings.clear();
+                for (int i = 0; i < count; i++)
+                {
+                    const IVECTOR2 &a = pts[i], &b = pts[(i + 1) % count];
+                    if ((a.y > yc) != (b.y > yc))
+                        crossings.push_back(a.x + (yc - a.y) * (b.x - a.x) / (double) (b.y - a.y));
+                }
+                sort(crossings.begin(), crossings.end());
+                for (size_t k = 0; k + 1 < crossings.size(); k += 2)
+                    fillSpan(y, (int) ceil(crossings[k] - 0.5), (int) ceil(crossings[k + 1] - 0.5), _brushColor);
+            }
+        }
+        for (int i = 0; i < count; i++)
+            penLine(pts[i].x, pts[i].y, pts[(i + 1) % count].x, pts[(i + 1) % count].y);
+    }
+
+    void Sketchpad::Polyline(const IVECTOR2* pts, int count)
+    {
+        for (int i = 0; i + 1 < count; i++)
+            penLine(pts[i].x, pts[i].y, pts[i + 1].x, pts[i + 1].y);
+    }
+
+
+
+    int Sketchpad::textWidth(const char* text, int length)
+    {
+        return length * glyphCellWidth * _fontScale;
+    }
+
+    void Sketchpad::drawText(int x, int y, const char* text, int length)
+    {
+        int s = _fontScale;
+        if (_backOpaque)
+            fillRect(x, y, x + textWidth(text, length), y + glyphCellHeight * s, _backColor);
+        for (int i = 0; i < length; i++)
+        {
+            unsigned char ch = (unsigned char) text[i];
+            const unsigned char* glyph = fontGlyphs[ch >= 32 && ch < 127 ? ch - 32 : '?' - 32];
+            int left = x + i * glyphCellWidth * s;
+            for (int col = 0; col < 5; col++)
+                for (int row = 0; row < glyphCellHeight; row++)
+                    if (glyph[col] & (1 << row))
+                    {
+                        int px = left + col * s, py = y + row * s;
+                        fillRect(px, py, px + s, py + s, _textColor);
+                        if (_fontStyle & FONT_BOLD)
+                            fillRect(px + 1, py, px + s + 1, py + s, _textColor);
+                    }
+        }
+        if (_fontStyle & FONT_UNDERLINE)
+            fillRect(x, y + glyphBaseline * s, x + textWidth(text, length), y + glyphBaseline * s + max(1, s / 2), _textColor);
+    }
+
+    void Sketchpad::Text(int x, int y, const string& text, HORZALIGN horzAlign, VERTALIGN vertAlign)
+    {
+        int width = textWidth(text.c_str(), text.size());
+        if (horzAlign == HA_CENTER)
+            x -= width / 2;
+        else if (horzAlign == HA_RIGHT)
+            x -= width;
+        if (vertAlign == VA_BASELINE)
+            y -= glyphBaseline * _fontScale;
+        else if (vertAlign == VA_BOTTOM)
+            y -= glyphCellHeight * _fontScale;
+        drawText(x, y, text.c_str(), text.size());
+    }
+
+    // Word-wraps the text to the box, breaking words that are too long for a line, and drops lines below the box
+    void Sketchpad::TextBox(int x1, int y1, int x2, int y2, const string& text)
+    {
+        int perLine = max(1, (x2 - x1) / (glyphCellWidth * _fontScale));
+        int lineHeight = glyphCellHeight * _fontScale;
+        int y = y1;
+        size_t pos = 0;
+        while (pos < text.size() && y + lineHeight <= y2)
+        {
+            size_t end = text.find('\n', pos);
+            if (end == string::npos)
+                end = text.size();
+            size_t lineEnd = end;
+            if ((int) (end - pos) > perLine)
+            {
+                size_t space = text.rfind(' ', pos + perLine);
+                lineEnd = space != string::npos && space > pos ? space : pos + perLine;
+            }
+            drawText(x1, y, text.c_str() + pos, lineEnd - pos);
+            y += lineHeight;
+            pos = lineEnd;
+            if (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n'))
+                pos++;
+        }
+    }
+
+}
+
+#endif
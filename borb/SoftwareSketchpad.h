@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "SketchpadHelper.h"
+
+#ifdef BORB_SOFTWARE_SKETCHPAD
+
+namespace borb {
+
+    class Brush : private boost::noncopyable
+    {
+    public:
+        Brush(DWORD color) : Color(color) { }
+        DWORD Color;
+    };
+
+    class Pen : private boost::noncopyable
+    {
+    public:
+        Pen(PENSTYLE style, int width, DWORD color) : Style(style), Width(width), Color(color) { }
+        PENSTYLE Style;
+        int Width;
+        DWORD Color;
+    };
+
+    class Font : private boost::noncopyable
+    {
+    public:
+        Font(int height, FONTSTYLE style) : Height(height), Style(style) { }
+        int Height;
+        FONTSTYLE Style;
+    };
+
+    // An in-memory raster implementation of the Sketchpad interface, used by SketchpadHelper in place of Orbiter's
+    // or GDI's in the headless build, which defines BORB_SOFTWARE_SKETCHPAD. Draws into an RGBA framebuffer, following GDI's conventions:
+    // colors are COLORREFs (0x00BBGGRR), lines and rectangles exclude their right and bottom edges, and polygons are
+    // filled with the alternate (even-odd) rule. Text uses a built-in 5x7 bitmap font, scaled by whole pixels to
+    // approximate the font height; typefaces, italics and orientation are ignored. The output is deterministic, so
+    // it can be compared against reference images.
+    class Sketchpad : private boost::noncopyable
+    {
+    public:
+        Sketchpad(int width, int height);
+
+        int GetWidth() { return _width; }
+        int GetHeight() { return _height; }
+        // The pixels, row by row from the top, as 0xAABBGGRR, i.e. the bytes R, G, B, A in memory.
+        const DWORD* GetPixels() { return &_pixels[0]; }
+        DWORD GetPixel(int x, int y) { return _pixels[y * _width + x]; }
+        void Clear(DWORD color = 0);
+
+        // Saves the image as a binary PPM file. Returns false if the file can't be written.
+        bool SavePPM(const std::string& filename);
+        // Compares the image with a binary PPM file, e.g. one saved earlier as a reference. Returns the number of
+        // pixels that differ, or -1 if the file can't be read or has a different size.
+        int ComparePPM(const std::string& filename);
+
+        void SetFont(Font* font);
+        void SetPen(Pen* pen);
+        void SetBrush(Brush* brush);
+
+        void SetTextColor(DWORD color) { _textColor = color; }
+        void SetTextBackColor(DWORD color) { _backColor = color; _backOpaque = true; }
+        void SetTextBackTransparent() { _backOpaque = false; }
+
+        void MoveTo(int x, int y) { _posX = x; _posY = y; }
+        void LineTo(int x, int y);
+        void Line(int x1, int y1, int x2, int y2);
+        void Rectangle(int x1, int y1, int x2, int y2);
+        void Ellipse(int x1, int y1, int x2, int y2);
+        void Polygon(const IVECTOR2* pts, int count);
+        void Polyline(const IVECTOR2* pts, int count);
+        void Text(int x, int y, const std::string& text, HORZALIGN horzAlign, VERTALIGN vertAlign);
+        void TextBox(int x1, int y1, int x2, int y2, const std::string& text);
+
+    private:
+        int _width, _height;
+        std::vector<DWORD> _pixels;
+        int _posX, _posY;
+
+        // Selected objects are copied, so that releasing them while selected is harmless
+        bool _penVisible, _brushVisible;
+        PENSTYLE _penStyle;
+        int _penWidth;
+        DWORD _penColor, _brushColor;
+        int _fontScale;
+        FONTSTYLE _fontStyle;
+        DWORD _textColor, _backColor;
+        bool _backOpaque;
+        unsigned _dashPhase; // position in the dash pattern, carried over from line to line like GDI's
+
+        inline void plot(int x, int y, DWORD color)
+        {
+            if (x >= 0 && y >= 0 && x < _width && y < _height)
+                _pixels[y * _width + x] = color | 0xFF000000;
+        }
+        void fillSpan(int y, int x1, int x2, DWORD color); // x1 to x2 exclusive
+        void fillRect(int x1, int y1, int x2, int y2, DWORD color); // exclusive of x2 and y2
+        void penDot(int x, int y);
+        void penLine(int x1, int y1, int x2, int y2); // excludes the end point
+        int textWidth(const char* text, int length);
+        void drawText(int x, int y, const char* text, int length); // x, y is the top left
+    };
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TaskScheduler.h"
+#include "Misc.h"
+
+namespace borb {
+
+    using namespace std;
+
+    int TaskScheduler::Add(double rate, const ScheduledTaskFunc& func, TaskClock clock, double phase)
+    {
+        if (!(rate > 0))
+            throw exception("TaskScheduler::Add: the rate must be positive.");
+        if (phase < 0)
+        {
+            // Successive multiples of the golden ratio are spread evenly over 0..1 however many there are, so every
+            // new task lands in the largest remaining gap between the existing ones.
+            phase = fmod(_autoPhaseCount * 0.6180339887498949, 1.0);
+            _autoPhaseCount++;
+        }
+
+        shared_ptr<task> t = make_shared<task>();
+        t->Id = _nextId++;
+        t->Func = func;
+        t->Clock = clock;
+        t->Interval = 1 / rate;
+        t->Phase = fmod(phase, 1.0);
+        t->Started = t->Removed = false;
+        t->Last = t->Next = 0;
+        _tasks.push_back(t);
+        return t->Id;
+    }
+
+    TaskScheduler::task* TaskScheduler::find(int id)
+    {
+        for (size_t i = 0; i < _tasks.size(); i++)
+            if (_tasks[i]->Id == id && !_tasks[i]->Removed)
+                return _tasks[i].get();
+        return NULL;
+    }
+
+    void TaskScheduler::Remove(int id)
+    {
+        task* t = find(id);
+        if (t == NULL)
+            return;
+        // While running, only mark it, so that Run's iteration is unaffected; Run erases marked tasks once it's done.
+        t->Removed = true;
+        if (!_running)
+            for (size_t i = 0; i < _tasks.size(); i++)
+                if (_tasks[i]->Id == id)
+                {
+                    _tasks.erase(_tasks.begin() + i);
+                    break;
+                }
+    }
+
+    void TaskScheduler::SetRate(int id, double rate)
+    {
+        if (!(rate > 0))
+            throw exception("TaskScheduler::SetRate: the rate must be positive.");
+        task* t = find(id);
+        if (t == NULL)
+            return;
+        t->Interval = 1 / rate;
+        if (t->Started)
+            schedule(*t, t->Last);
+    }
+
+    void TaskScheduler::Clear()
+    {
+        if (_running)
+        {
+            for (size_t i = 0; i < _tasks.size(); i++)
+                _tasks[i]->Removed = true;
+        }
+        else
+            _tasks.clear();
+        _autoPhaseCount = 0;
+    }
+
+    void TaskScheduler::Reset()
+    {
+        for (size_t i = 0; i < _tasks.size(); i++)
+            _tasks[i]->Started = false;
+    }
+
+    // Sets the task to next run at the first time after "now" that falls on its phase. The small tolerance prevents
+    // rounding errors from scheduling the run that has just happened a second time.
+    void TaskScheduler::schedule(task& t, double now)
+    {
+        t.Next = (floor(now / t.Interval - t.Phase + 1e-6) + 1 + t.Phase) * t.Interval;
+    }
+
+    void TaskScheduler::Run(double simt, double simdt, double mjd)
+    {
+        if (_tasks.empty())
+            return;
+
+        double realt = PreciseTicksToSeconds(GetPreciseTicks());
+        _running = true;
+        // Tasks added by a running task will only be considered on the next frame
+        size_t count = _tasks.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            // Hold a reference, in case the task removes itself and the vector reallocates as a result of other tasks being added
+            shared_ptr<task> t = _tasks[i];
+            if (t->Removed)
+                continue;
+            double now = t->Clock == TaskClockSimTime ? simt : realt;
+
+            // Also restart a task whose clock went backwards (e.g. a scenario was loaded without a restart)
+            if (!t->Started || now < t->Last)
+            {
+                t->Started = true;
+                t->Last = now;
+                schedule(*t, now);
+                continue;
+            }
+            if (now < t->Next)
+                continue;
+
+            double elapsed = now - t->Last;
+            t->Last = now;
+            // Skip any run times missed since the last run, rather than trying to catch up on successive frames
+            schedule(*t, now);
+            try
+            {
+                t->Func(simt, elapsed, mjd);
+            }
+            catch (...)
+            {
+                _running = false;
+                throw;
+            }
+        }
+        _running = false;
+
+        for (size_t i = 0; i < _tasks.size(); )
+        {
+            if (_tasks[i]->Removed)
+                _tasks.erase(_tasks.begin() + i);
+            else
+                i++;
+        }
+    }
+
+}
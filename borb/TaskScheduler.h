@@ -0,0 +1,73 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    // The clock against which a scheduled task's rate is measured.
+    enum TaskClock
+    {
+        // Simulation time: the task runs more often in wall-clock terms under time acceleration, and not at all while
+        // paused. Use this for anything that tracks the state of the simulated world.
+        TaskClockSimTime,
+        // Wall-clock time: the task runs at the same real rate regardless of time acceleration, including while paused.
+        // Use this for things that are only shown to the user, such as refreshing a display.
+        TaskClockRealTime,
+    };
+
+    // The callback of a scheduled task. "elapsed" is the time, measured on the task's clock, since the task last ran
+    // (or since it was added). It is usually close to the task's interval, but may be much larger, e.g. when the rate
+    // exceeds the frame rate, or when the time acceleration makes a single frame span several intervals - in which case
+    // the task only runs once, and should use "elapsed" to catch up.
+    typedef std::function<void (double simt, double elapsed, double mjd)> ScheduledTaskFunc;
+
+    // Runs tasks at their own rates instead of on every frame. Every task has a phase, a fraction of its interval by
+    // which its run times are offset, so that tasks sharing a rate don't all run on the same frame. Tasks without an
+    // explicit phase are spread out automatically. A task runs at most once per frame.
+    class TaskScheduler : private boost::noncopyable
+    {
+    public:
+        TaskScheduler() : _nextId(1), _autoPhaseCount(0), _running(false) { }
+
+        // Adds a task to be run "rate" times per second on the specified clock. "phase" is in the range 0..1; if
+        // negative, a phase is picked that spreads this task away from the others. Returns an id for Remove/SetRate.
+        int Add(double rate, const ScheduledTaskFunc& func, TaskClock clock = TaskClockSimTime, double phase = -1);
+        // Removes the specified task. May be called from within a task, including the task being removed.
+        void Remove(int id);
+        // Changes the rate of the specified task, keeping its phase.
+        void SetRate(int id, double rate);
+        // Removes all tasks.
+        void Clear();
+
+        // Forgets when each task last ran, so that the next Run starts them afresh. Module.cpp.h calls this when a new
+        // simulation starts, since the simulation time of the previous one is meaningless in the next.
+        void Reset();
+
+        // Runs every task that is due. Module.cpp.h calls this after ModuleBase::PreStep.
+        void Run(double simt, double simdt, double mjd);
+
+    private:
+        struct task
+        {
+            int Id;
+            ScheduledTaskFunc Func;
+            TaskClock Clock;
+            double Interval, Phase;
+            bool Started, Removed;
+            double Last, Next; // in seconds on the task's clock
+        };
+
+        std::vector<std::shared_ptr<task>> _tasks;
+        int _nextId, _autoPhaseCount;
+        bool _running;
+
+        task* find(int id);
+        void schedule(task& t, double now);
+    };
+
+}
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TimeSeriesPlot.h"
+
+namespace borb {
+
+    using namespace std;
+
+    void TimeSeriesPlot::Add(double time, double value)
+    {
+        if (!_times.empty() && time < _times.back())
+            throw runtime_error("TimeSeriesPlot: samples must be added in time order.");
+        if (_capacity > 0 && (int) _times.size() >= _capacity)
+            removeFirst(max(1, _capacity / 4));
+        _times.push_back(time);
+        _values.push_back(value);
+
+        // Complete every block that this sample completes, bottom up
+        size_t count = _values.size();
+        for (size_t k = 0; (count & (((size_t) 2 << k) - 1)) == 0; k++)
+        {
+            if (_levels.size() <= k)
+                _levels.push_back(vector<minMax>());
+            minMax block;
+            if (k == 0)
+            {
+                block.Min = min(_values[count - 2], _values[count - 1]);
+                block.Max = max(_values[count - 2], _values[count - 1]);
+            }
+            else
+            {
+                const vector<minMax>& below = _levels[k - 1];
+                const minMax &a = below[below.size() - 2], &b = below[below.size() - 1];
+                block.Min = min(a.Min, b.Min);
+                block.Max = max(a.Max, b.Max);
+            }
+            _levels[k].push_back(block);
+        }
+    }
+
+    void TimeSeriesPlot::RemoveBefore(double time)
+    {
+        removeFirst(findTime(time, 0));
+    }
+
+    // Removes the oldest samples and rebuilds the pyramid from the remaining ones, level by level
+    void TimeSeriesPlot::removeFirst(int count)
+    {
+        if (count <= 0)
+            return;
+        _times.erase(_times.begin(), _times.begin() + count);
+        _values.erase(_values.begin(), _values.begin() + count);
+        _levels.clear();
+        for (size_t k = 0; ((size_t) 2 << k) <= _values.size(); k++)
+        {
+            _levels.push_back(vector<minMax>(_values.size() >> (k + 1)));
+            vector<minMax>& level = _levels[k];
+            for (size_t i = 0; i < level.size(); i++)
+            {
+                if (k == 0)
+                {
+                    level[i].Min = min(_values[2 * i], _values[2 * i + 1]);
+                    level[i].Max = max(_values[2 * i], _values[2 * i + 1]);
+                }
+                else
+                {
+                    const minMax &a = _levels[k - 1][2 * i], &b = _levels[k - 1][2 * i + 1];
+                    level[i].Min = min(a.Min, b.Min);
+                    level[i].Max = max(a.Max, b.Max);
+                }
+            }
+        }
+    }
+
+    void TimeSeriesPlot::Clear()
+    {
+        _times.clear();
+        _values.clear();
+        _levels.clear();
+    }
+
+    // Covers the range with the largest aligned blocks that fit, so at most two blocks per level are used
+    void TimeSeriesPlot::rangeMinMax(int begin, int end, double& minValue, double& maxValue)
+    {
+        minValue = _values[begin];
+        maxValue = _values[begin];
+        size_t i = begin;
+        while (i < (size_t) end)
+        {
+            int k = -1; // level of the block starting at i; -1 for a single sample
+            while (k + 1 < (int) _levels.size() && (i & (((size_t) 2 << (k + 1)) - 1)) == 0 && i + ((size_t) 2 << (k + 1)) <= (size_t) end)
+                k++;
+            if (k < 0)
+            {
+                minValue = min(minValue, _values[i]);
+                maxValue = max(maxValue, _values[i]);
+                i++;
+            }
+            else
+            {
+                const minMax& block = _levels[k][i >> (k + 1)];
+                minValue = min(minValue, block.Min);
+                maxValue = max(maxValue, block.Max);
+                i += (size_t) 2 << k;
+            }
+        }
+    }
+
+    int TimeSeriesPlot::findTime(double time, int from)
+    {
+        return (int) (lower_bound(_times.begin() + from, _times.end(), time) - _times.begin());
+    }
+
+    bool TimeSeriesPlot::GetRange(double timeFrom, double timeTo, double& minValue, double& maxValue)
+    {
+        int begin = findTime(timeFrom, 0);
+        int end = (int) (upper_bound(_times.begin() + begin, _times.end(), timeTo) - _times.begin());
+        if (begin >= end)
+            return false;
+        rangeMinMax(begin, end, minValue, maxValue);
+        return true;
+    }
+
+    void TimeSeriesPlot::Draw(SketchpadHelper* skh, double x1, double y1, double x2, double y2, double timeFrom, double timeTo, double valueMin, double valueMax)
+    {
+        double pixel = skh->GetPixelSize();
+        int columns = (int) ((x2 - x1) / pixel);
+        if (columns <= 0 || !(timeTo > timeFrom) || !(valueMax > valueMin))
+            return;
+        double columnTime = (timeTo - timeFrom) / columns;
+        double yScale = (y2 - y1) / (valueMax - valueMin);
+
+        _points.clear();
+        double last = 0; // the last value drawn
+        int begin = findTime(timeFrom, 0);
+        for (int c = 0; c < columns && begin < (int) _times.size(); c++)
+        {
+            int end = c == columns - 1
+                ? (int) (upper_bound(_times.begin() + begin, _times.end(), timeTo) - _times.begin())
+                : findTime(timeFrom + (c + 1) * columnTime, begin);
+            if (end <= begin)
+                continue;
+            double lo, hi;
+            rangeMinMax(begin, end, lo, hi);
+            begin = end;
+
+            // From whichever end of the range is nearer the previous column, so that the line joins up naturally
+            VECTOR2 pt;
+            pt.x = x1 + (c + 0.5) * pixel;
+            bool upwards = _points.empty() || last - lo < hi - last;
+            double first = upwards ? lo : hi, second = upwards ? hi : lo;
+            pt.y = y2 - (min(max(first, valueMin), valueMax) - valueMin) * yScale;
+            _points.push_back(pt);
+            if (second != first)
+            {
+                pt.y = y2 - (min(max(second, valueMin), valueMax) - valueMin) * yScale;
+                _points.push_back(pt);
+            }
+            last = second;
+        }
+
+        if (_points.size() == 1)
+            skh->DrawLine(_points[0].x, _points[0].y, _points[0].x + pixel, _points[0].y); // a polyline of one point draws nothing
+        else if (!_points.empty())
+            skh->DrawPolyline(&_points[0], (int) _points.size());
+    }
+
+    void TimeSeriesPlot::DrawGrid(SketchpadHelper* skh, double x1, double y1, double x2, double y2, double timeFrom, double timeTo, double valueMin, double valueMax, int maxTimeTicks, int maxValueTicks)
+    {
+        if (timeTo > timeFrom)
+        {
+            MakeTicks(timeFrom, timeTo, maxTimeTicks, _ticks);
+            for (size_t i = 0; i < _ticks.size(); i++)
+            {
+                double x = x1 + (_ticks[i] - timeFrom) / (timeTo - timeFrom) * (x2 - x1);
+                skh->DrawLine(x, y1, x, y2);
+            }
+        }
+        if (valueMax > valueMin)
+        {
+            MakeTicks(valueMin, valueMax, maxValueTicks, _ticks);
+            for (size_t i = 0; i < _ticks.size(); i++)
+            {
+                double y = y2 - (_ticks[i] - valueMin) / (valueMax - valueMin) * (y2 - y1);
+                skh->DrawLine(x1, y, x2, y);
+            }
+        }
+    }
+
+    // The smallest round number (1, 2 or 5 times a power of ten) at least as large as the value
+    static double niceNumber(double value)
+    {
+        double power = pow(10.0, floor(log10(value)));
+        double fraction = value / power;
+        return (fraction <= 1 ? 1 : fraction <= 2 ? 2 : fraction <= 5 ? 5 : 10) * power;
+    }
+
+    double TimeSeriesPlot::MakeTicks(double from, double to, int maxTicks, vector<double>& ticks)
+    {
+        ticks.clear();
+        if (!(to > from) || maxTicks < 2)
+            return 0;
+        double spacing = niceNumber((to - from) / (maxTicks - 1));
+        double first = ceil(from / spacing - 1e-9);
+        for (double n = first; n * spacing <= to + spacing * 1e-9; n++)
+            ticks.push_back(n * spacing == 0 ? 0 : n * spacing); // no negative zero
+        return spacing;
+    }
+
+    string TimeSeriesPlot::FormatTick(double value, double spacing)
+    {
+        int decimals = spacing > 0 ? max(0, (int) -floor(log10(spacing) + 1e-9)) : 0;
+        ostringstream str;
+        str << fixed << setprecision(decimals) << value;
+        return str.str();
+    }
+
+}
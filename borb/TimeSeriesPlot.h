@@ -0,0 +1,69 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "SketchpadHelper.h"
+
+namespace borb {
+
+    // Plots a long history of samples on an MFD. Instead of drawing every sample, each pixel column of the plot is
+    // drawn as the range of the samples within it, from their minimum to their maximum, so a plot is at most two
+    // points per column however many samples it covers, and looks exactly like the full line would. Column ranges
+    // come from a pyramid of per-block minima and maxima (blocks of 2, 4, 8... samples), built as samples are added,
+    // so drawing any time range at any zoom costs O(log n) per column rather than O(n). To bound the memory used, give
+    // the plot a capacity, or call RemoveBefore from time to time.
+    class TimeSeriesPlot
+    {
+    public:
+        // If capacity is positive, the plot keeps at most that many samples: adding one more discards the oldest quarter of
+        // them at once, so that the pyramid only has to be rebuilt every so often.
+        TimeSeriesPlot(int capacity = 0) : _capacity(capacity) { }
+
+        // Appends a sample. Times must not decrease.
+        void Add(double time, double value);
+        // Discards the samples before the time. This rebuilds the pyramid, so it costs O(n).
+        void RemoveBefore(double time);
+        void Clear();
+        int GetCount() { return (int) _times.size(); }
+        double GetTime(int index) { return _times[index]; }
+        double GetValue(int index) { return _values[index]; }
+
+        // Finds the smallest and largest values in the time range, e.g. to scale the plot. Returns false if there are
+        // no samples in the range.
+        bool GetRange(double timeFrom, double timeTo, double& minValue, double& maxValue);
+
+        // Draws the samples in the time range with the current pen, in the rectangle x1, y1 - x2, y2 (in the helper's
+        // units, y1 at the top), with the value range scaled to fit the rectangle and values beyond it clamped to its edges.
+        void Draw(SketchpadHelper* skh, double x1, double y1, double x2, double y2, double timeFrom, double timeTo, double valueMin, double valueMax);
+        // Draws grid lines across the rectangle with the current pen, at the ticks for the time and value ranges.
+        void DrawGrid(SketchpadHelper* skh, double x1, double y1, double x2, double y2, double timeFrom, double timeTo, double valueMin, double valueMax, int maxTimeTicks = 5, int maxValueTicks = 5);
+
+        // Fills "ticks" with at most maxTicks evenly spaced round numbers (multiples of 1, 2 or 5 times a power of
+        // ten) between "from" and "to", inclusive, and returns the spacing.
+        static double MakeTicks(double from, double to, int maxTicks, std::vector<double>& ticks);
+        // Formats a tick value with as many decimals as the tick spacing needs.
+        static std::string FormatTick(double value, double spacing);
+
+    private:
+        struct minMax
+        {
+            double Min, Max;
+        };
+
+        int _capacity;
+        std::vector<double> _times, _values;
+        std::vector<std::vector<minMax>> _levels; // _levels[k][i] covers samples i * 2^(k+1) to (i + 1) * 2^(k+1) - 1
+        std::vector<VECTOR2> _points; // reused from call to call
+        std::vector<double> _ticks;
+
+        void removeFirst(int count);
+        void rangeMinMax(int begin, int end, double& minValue, double& maxValue);
+        int findTime(double time, int from); // index of the first sample at or after the time, searching from "from"
+    };
+
+}
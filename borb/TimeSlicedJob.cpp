@@ -0,0 +1,52 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TimeSlicedJob.h"
+#include "Misc.h"
+#include "Trace.h"
+
+namespace borb {
+
+    using namespace std;
+
+    void TimeSlicedJobQueue::Add(const shared_ptr<TimeSlicedJob>& job)
+    {
+        if (!job->IsFinished())
+            _jobs.push_back(job);
+    }
+
+    void TimeSlicedJobQueue::CancelAll()
+    {
+        for (vector<shared_ptr<TimeSlicedJob>>::iterator it = _jobs.begin(); it != _jobs.end(); it++)
+            (*it)->Cancel();
+        _jobs.clear();
+        _next = 0;
+    }
+
+    void TimeSlicedJobQueue::Run()
+    {
+        if (_jobs.empty())
+            return;
+        BORB_TRACE_SCOPE("TimeSlicedJobQueue::Run");
+
+        long long start = GetPreciseTicks();
+        do
+        {
+            if (_next >= _jobs.size())
+                _next = 0;
+            shared_ptr<TimeSlicedJob> job = _jobs[_next]; // a copy, as Step is allowed to add or cancel jobs
+            if (!job->_finished && job->Step())
+                job->_finished = true;
+            if (!job->_finished)
+                _next++;
+            else if (_next < _jobs.size() && _jobs[_next] == job)
+                _jobs.erase(_jobs.begin() + _next);
+        }
+        while (!_jobs.empty() && PreciseTicksToSeconds(GetPreciseTicks() - start) < _budgetSeconds);
+    }
+
+}
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    // A long-running computation split into many small steps, so that it can be advanced a little on every frame
+    // instead of stalling the simulation. Add it to a TimeSlicedJobQueue (e.g. ModuleBase::Jobs) to have it run.
+    // Everything happens on the simulation thread, so Step may use the Orbiter API, and MFDs may read any partial
+    // results the job exposes without synchronization.
+    class TimeSlicedJob : private boost::noncopyable
+    {
+    public:
+        TimeSlicedJob() : _finished(false), _cancelled(false) { }
+        virtual ~TimeSlicedJob() { }
+
+        // True once the job has performed its final step, or has been cancelled.
+        bool IsFinished() { return _finished; }
+        // True if the job was stopped by Cancel before it could finish.
+        bool IsCancelled() { return _cancelled; }
+        // Stops the job; Step will not be called again.
+        void Cancel() { _cancelled = _finished = true; }
+
+        // Returns the fraction of the work done so far, in the range 0..1. Override this to let MFDs display progress.
+        virtual double GetProgress() { return _finished ? 1 : 0; }
+
+    protected:
+        // Performs the next chunk of work and returns true if the job is now complete. The time budget is only checked
+        // between steps, so a single step should take no more than a few tens of microseconds.
+        virtual bool Step() = 0;
+
+    private:
+        bool _finished, _cancelled;
+
+        friend class TimeSlicedJobQueue;
+    };
+
+    // A TimeSlicedJob that builds up a result of type TResult. The result may be read at any time; while the job is
+    // running it holds whatever partial result the job has published so far.
+    template<typename TResult>
+    class TimeSlicedJobWithResult : public TimeSlicedJob
+    {
+    public:
+        const TResult& GetResult() { return _result; }
+
+    protected:
+        TResult _result;
+    };
+
+    // Advances a set of TimeSlicedJobs, interleaving their steps, without exceeding a time budget per call.
+    class TimeSlicedJobQueue : private boost::noncopyable
+    {
+    public:
+        TimeSlicedJobQueue() : _budgetSeconds(0.002), _next(0) { }
+
+        // Queues the job. It gets its first step on the next call to Run.
+        void Add(const std::shared_ptr<TimeSlicedJob>& job);
+        // Cancels and removes every queued job.
+        void CancelAll();
+        // True if there are no unfinished jobs in the queue.
+        bool IsEmpty() { return _jobs.empty(); }
+
+        // Sets the maximum time a single call to Run may take. Defaults to 2000 microseconds.
+        void SetBudget(double microseconds) { _budgetSeconds = microseconds / 1e6; }
+        double GetBudget() { return _budgetSeconds * 1e6; }
+
+        // Steps the queued jobs in round-robin fashion until the time budget is used up or no jobs remain. Performs at
+        // least one step per call, so jobs keep making progress even with a tiny budget. Finished jobs are removed.
+        void Run();
+
+    private:
+        std::vector<std::shared_ptr<TimeSlicedJob>> _jobs;
+        double _budgetSeconds;
+        size_t _next; // index of the job to step next, so that every job gets a fair share across calls
+    };
+
+}
@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "TimeWeightedAverage.h"
+
+namespace borb {
+
+    using namespace std;
+
+    void ExponentialAverage::Update(double mjd, double value)
+    {
+        if (_first)
+        {
+            _average = _lastValue = value;
+            _lastMJD = mjd;
+            _first = false;
+            return;
+        }
+        double dt = (mjd - _lastMJD) * 86400;
+        if (dt <= 0)
+            return;
+
+        // Exact EMA of a signal that is linear between the previous and this sample (Eckner, "Algorithms for Unevenly
+        // Spaced Time Series", 2017): mu is the decay over the interval, and w the mean decay over it.
+        double x = dt / _tau;
+        double mu = exp(-x);
+        double w = x < 1e-6 ? 1 - x / 2 : (1 - mu) / x; // avoid the cancellation in (1 - mu) / x for tiny intervals
+        _average = mu * _average + (w - mu) * _lastValue + (1 - w) * value;
+        _lastValue = value;
+        _lastMJD = mjd;
+    }
+
+
+
+    TimeWeightedWindowAverage::TimeWeightedWindowAverage(double windowSeconds, int slots)
+    {
+        if (!(windowSeconds > 0) || slots <= 0)
+            throw exception("TimeWeightedWindowAverage: the window and the slot count must be positive.");
+        _windowSeconds = windowSeconds;
+        _slotSeconds = windowSeconds / slots;
+        _slots.resize(slots + 1);
+        _first = true;
+    }
+
+    void TimeWeightedWindowAverage::advanceSlot(double start)
+    {
+        _current = (_current + 1) % _slots.size();
+        _slots[_current] = 0;
+        _currentStart = start;
+    }
+
+    void TimeWeightedWindowAverage::Update(double mjd, double value)
+    {
+        if (_first)
+        {
+            _first = false;
+            _originMJD = mjd;
+            _lastTime = 0;
+            _lastValue = value;
+            fill(_slots.begin(), _slots.end(), 0.0);
+            _current = 0;
+            _currentStart = 0;
+            return;
+        }
+        double t0 = _lastTime, v0 = _lastValue;
+        double t1 = (mjd - _originMJD) * 86400, v1 = value;
+        if (t1 <= t0)
+            return;
+
+        // After a long gap, everything before the last window-and-a-slot is irrelevant: start from there, with empty slots
+        double skipTo = t1 - _slots.size() * _slotSeconds;
+        if (skipTo > _currentStart + _slotSeconds)
+        {
+            skipTo = floor(skipTo / _slotSeconds) * _slotSeconds;
+            v0 = v0 + (v1 - v0) * (skipTo - t0) / (t1 - t0);
+            t0 = skipTo;
+            fill(_slots.begin(), _slots.end(), 0.0);
+            _currentStart = skipTo;
+        }
+
+        // Integrate the linear segment (t0, v0) - (t1, v1), splitting it at slot boundaries
+        while (t1 > _currentStart + _slotSeconds)
+        {
+            double tb = _currentStart + _slotSeconds;
+            double vb = v0 + (v1 - v0) * (tb - t0) / (t1 - t0);
+            _slots[_current] += (v0 + vb) / 2 * (tb - t0);
+            t0 = tb;
+            v0 = vb;
+            advanceSlot(tb);
+        }
+        _slots[_current] += (v0 + v1) / 2 * (t1 - t0);
+
+        _lastTime = t1;
+        _lastValue = value;
+    }
+
+    double TimeWeightedWindowAverage::GetAverage()
+    {
+        if (_first)
+            return numeric_limits<double>::quiet_NaN();
+        double covered = min(_windowSeconds, _lastTime);
+        if (covered <= 0)
+            return _lastValue;
+
+        // The slot after the current one in the ring is the oldest; only part of it is still within the window
+        size_t oldest = (_current + 1) % _slots.size();
+        double total = 0;
+        for (size_t i = 0; i < _slots.size(); i++)
+            if (i != oldest)
+                total += _slots[i];
+        total += _slots[oldest] * (1 - (_lastTime - _currentStart) / _slotSeconds);
+        return total / covered;
+    }
+
+}
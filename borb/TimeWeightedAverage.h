@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    // An exponential moving average for irregularly spaced samples. Unlike a per-sample EMA, the weight of each
+    // sample depends on the time since the previous one, and the signal is taken to vary linearly between samples,
+    // so the result is the same whatever the frame rate or time acceleration. Keeps three doubles of state.
+    class ExponentialAverage
+    {
+    public:
+        // timeConstantSeconds is the time after which the weight of a sample has decayed to 1/e.
+        ExponentialAverage(double timeConstantSeconds) : _tau(timeConstantSeconds), _first(true) { }
+
+        void Update(double mjd, double value);
+        // Returns the average, or NaN before the first Update.
+        double GetAverage() { return _first ? std::numeric_limits<double>::quiet_NaN() : _average; }
+        void Reset() { _first = true; }
+
+    private:
+        double _tau;
+        bool _first;
+        double _average, _lastValue, _lastMJD;
+    };
+
+    // The time-weighted average of a signal over the last windowSeconds, taking the signal to vary linearly between
+    // samples (i.e. trapezoidal integration), so that periods of dense sampling don't outweigh sparse ones. Instead
+    // of keeping every sample, the integral is kept per time slot, windowSeconds / slots long, so the memory used is
+    // fixed however many samples the window spans; the oldest slot is weighted by the fraction of it still inside the
+    // window, which makes the result exact for a signal that is constant within that slot.
+    class TimeWeightedWindowAverage
+    {
+    public:
+        TimeWeightedWindowAverage(double windowSeconds, int slots = 16);
+
+        void Update(double mjd, double value);
+        // Returns the average over the window, or over all the samples so far if they span less than the window.
+        // Returns the only sample if there is just one, or NaN before the first Update.
+        double GetAverage();
+        void Reset() { _first = true; }
+
+    private:
+        double _windowSeconds, _slotSeconds;
+        std::vector<double> _slots; // integral of the signal over each slot; one more slot than requested, for the current one
+        int _current; // index of the slot containing the latest sample
+        double _currentStart; // start of the current slot, in seconds since _originMJD
+        bool _first;
+        double _originMJD, _lastTime, _lastValue; // times in seconds since _originMJD, for precision
+
+        void advanceSlot(double start);
+    };
+
+}
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "Trace.h"
+#include "Misc.h"
+
+#include <fstream>
+
+namespace borb {
+
+    using namespace std;
+
+    struct TraceEvent
+    {
+        const char* Name;
+        unsigned long long Start, End;
+    };
+
+    struct TraceThreadBuffer
+    {
+        enum { capacity = 65536 }; // must be a power of two
+
+        DWORD ThreadId;
+        volatile unsigned int Written; // total number of events ever recorded; only ever modified by the owning thread
+        unsigned int Flushed; // value of Written at the last flush; only ever modified by the flushing thread
+        TraceEvent Events[capacity];
+    };
+
+    static struct TraceGlobals
+    {
+        CRITICAL_SECTION Lock; // guards Buffers
+        DWORD TlsIndex;
+        vector<TraceThreadBuffer*> Buffers;
+        // A pair of simultaneous __rdtsc/QueryPerformanceCounter readings, used to convert __rdtsc to microseconds
+        unsigned long long StartTsc;
+        long long StartTicks;
+
+        TraceGlobals()
+        {
+            InitializeCriticalSection(&Lock);
+            TlsIndex = TlsAlloc();
+            StartTsc = __rdtsc();
+            StartTicks = GetPreciseTicks();
+        }
+
+        ~TraceGlobals()
+        {
+            for (size_t i = 0; i < Buffers.size(); i++)
+                delete Buffers[i];
+            TlsFree(TlsIndex);
+            DeleteCriticalSection(&Lock);
+        }
+    } traceGlobals;
+
+    static TraceThreadBuffer* getThreadBuffer()
+    {
+        TraceThreadBuffer* buffer = (TraceThreadBuffer*) TlsGetValue(traceGlobals.TlsIndex);
+        if (buffer == NULL)
+        {
+            buffer = new TraceThreadBuffer();
+            buffer->ThreadId = GetCurrentThreadId();
+            buffer->Written = buffer->Flushed = 0;
+            TlsSetValue(traceGlobals.TlsIndex, buffer);
+            EnterCriticalSection(&traceGlobals.Lock);
+            traceGlobals.Buffers.push_back(buffer);
+            LeaveCriticalSection(&traceGlobals.Lock);
+        }
+        return buffer;
+    }
+
+    void TraceRecord(const char* name, unsigned long long start, unsigned long long end)
+    {
+        TraceThreadBuffer* buffer = getThreadBuffer();
+        unsigned int written = buffer->Written;
+        TraceEvent& ev = buffer->Events[written & (TraceThreadBuffer::capacity - 1)];
+        ev.Name = name;
+        ev.Start = start;
+        ev.End = end;
+        _WriteBarrier(); // the event must be complete before a flushing thread can see the new count
+        buffer->Written = written + 1;
+    }
+
+    static bool isThreadAlive(DWORD threadId)
+    {
+        HANDLE thread = OpenThread(THREAD_QUERY_INFORMATION, FALSE, threadId);
+        if (thread == NULL)
+            return false;
+        DWORD exitCode;
+        bool alive = GetExitCodeThread(thread, &exitCode) && exitCode == STILL_ACTIVE;
+        CloseHandle(thread);
+        return alive;
+    }
+
+    static void writeJsonString(ofstream& file, const char* str)
+    {
+        file << '"';
+        for (; *str != 0; str++)
+        {
+            if (*str == '"' || *str == '\\')
+                file << '\\';
+            if ((unsigned char) *str >= 0x20)
+                file << *str;
+        }
+        file << '"';
+    }
+
+    bool TraceWriteChromeJson(const string& filename)
+    {
+        ofstream file(filename.c_str());
+        if (!file)
+            return false;
+
+        double tscPerMicrosecond = (__rdtsc() - traceGlobals.StartTsc) / (PreciseTicksToSeconds(GetPreciseTicks() - traceGlobals.StartTicks) * 1e6);
+        if (!(tscPerMicrosecond > 0))
+            tscPerMicrosecond = 1;
+        DWORD processId = GetCurrentProcessId();
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << fixed << setprecision(3);
+        bool first = true;
+
+        EnterCriticalSection(&traceGlobals.Lock);
+        for (size_t b = 0; b < traceGlobals.Buffers.size(); )
+        {
+            TraceThreadBuffer* buffer = traceGlobals.Buffers[b];
+            unsigned int written = buffer->Written;
+            _ReadBarrier();
+            unsigned int count = min(written - buffer->Flushed, (unsigned int) TraceThreadBuffer::capacity);
+            for (unsigned int i = written - count; i != written; i++)
+            {
+                const TraceEvent& ev = buffer->Events[i & (TraceThreadBuffer::capacity - 1)];
+                file << (first ? "\n" : ",\n") << "{\"ph\":\"X\",\"name\":";
+                writeJsonString(file, ev.Name);
+                file << ",\"pid\":" << processId << ",\"tid\":" << buffer->ThreadId
+                    << ",\"ts\":" << (ev.Start - traceGlobals.StartTsc) / tscPerMicrosecond
+                    << ",\"dur\":" << (ev.End - ev.Start) / tscPerMicrosecond << "}";
+                first = false;
+            }
+            buffer->Flushed = written;
+
+            // Threads come and go (e.g. the worker pool is restarted for every simulation), so free the buffers of threads
+            // that no longer exist. Nothing else can be using them, as the buffer pointer is only stored in that thread's TLS.
+            if (!isThreadAlive(buffer->ThreadId))
+            {
+                delete buffer;
+                traceGlobals.Buffers.erase(traceGlobals.Buffers.begin() + b);
+            }
+            else
+                b++;
+        }
+        LeaveCriticalSection(&traceGlobals.Lock);
+
+        file << "\n]}\n";
+        return !file.fail();
+    }
+
+}
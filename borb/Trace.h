@@ -0,0 +1,55 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+// Lightweight tracing of named scopes, viewable in chrome://tracing or Perfetto. Put BORB_TRACE_SCOPE("name") at the
+// start of any block to be traced; the macro compiles to nothing unless BORB_TRACE is defined. Each thread records
+// into its own fixed-size ring buffer without locking, so a traced scope costs only a few nanoseconds; once a buffer
+// is full, the oldest events of that thread are overwritten. Call TraceWriteChromeJson to save everything recorded
+// so far (Module.cpp.h does this automatically at the end of the simulation when BORB_TRACE is defined).
+//
+// The name must be a string literal, or otherwise remain valid until the trace has been written.
+
+#define BORB_TRACE_CONCAT2(a, b) a##b
+#define BORB_TRACE_CONCAT(a, b) BORB_TRACE_CONCAT2(a, b)
+
+#ifdef BORB_TRACE
+#  define BORB_TRACE_SCOPE(name) borb::TraceScope BORB_TRACE_CONCAT(borbTraceScope, __LINE__)(name)
+#else
+#  define BORB_TRACE_SCOPE(name)
+#endif
+
+namespace borb {
+
+    // Records a completed scope, with start and end times measured by __rdtsc, into the calling thread's buffer.
+    void TraceRecord(const char* name, unsigned long long start, unsigned long long end);
+
+    // Writes every event recorded so far, by all threads, to the specified file in the Chrome trace event format,
+    // and empties the buffers. Events recorded by other threads while this runs may be missing or garbled, so call it
+    // when the worker threads are idle. Returns false if the file could not be written.
+    bool TraceWriteChromeJson(const std::string& filename);
+
+    // Measures the time between its construction and destruction; see BORB_TRACE_SCOPE.
+    class TraceScope : private boost::noncopyable
+    {
+    public:
+        TraceScope(const char* name) : _name(name), _start(__rdtsc()) { }
+        ~TraceScope() { TraceRecord(_name, _start, __rdtsc()); }
+
+    private:
+        const char* _name;
+        unsigned long long _start;
+    };
+
+}
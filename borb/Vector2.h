@@ -0,0 +1,20 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    union VECTOR2
+    {
+	    double data[2];
+	    struct { double x, y; };
+        VECTOR2() { x = 0; y = 0; }
+        VECTOR2(double x_, double y_) { x = x_; y = y_; }
+    };
+
+}
@@ -11,8 +11,21 @@ namespace borb {
 
     using namespace std;
 
-    void VesselAccelerationTracker::PreStep(VESSEL *vessel, double simdt)
+    void VesselAccelerationTracker::PreStep(VESSEL *vessel)
     {
+        // Measure the interval since the previous call, so that the result is correct however often this is called.
+        // No time passes while paused, so keep the previous values until it does. Time going backwards means a
+        // scenario was reloaded or the time was reset, so the previous velocity is meaningless: start over.
+        double simt = oapiGetSimTime();
+        double dt = simt - _simtLast;
+        if (!_first && dt < 0)
+        {
+            _first = true;
+            _filterStarted = false;
+        }
+        if (!_first && dt == 0)
+            return;
+
         MATRIX3 vesselRotLocal2Global;
         vessel->GetRotationMatrix(vesselRotLocal2Global);
 
@@ -21,11 +34,19 @@ namespace borb {
         vessel->GetWeightVector(gravForce);
         GravAccel = mul(vesselRotLocal2Global, gravForce / vessel->GetMass());
         vessel->GetGlobalVel(vel);
-        TotalAccel = (vel - _lastGlobalVel) / _simdtLast; // true acceleration in the inertial reference frame
+        TotalAccel = (vel - _lastGlobalVel) / dt; // true acceleration in the inertial reference frame
         PerceivedAccel = tmul(vesselRotLocal2Global, TotalAccel - GravAccel); // perceived acceleration onboard the ship
-        _simdtLast = simdt;
+        _simtLast = simt;
         _lastGlobalVel = vel;
 
+        if (_filterEnabled)
+        {
+            updateFilter(vel, GravAccel, _first ? 0 : dt);
+            SmoothedPerceivedAccel = tmul(vesselRotLocal2Global, _filterAccel - GravAccel);
+            Jerk = tmul(vesselRotLocal2Global, _filterJerk);
+            AccelUncertainty = sqrt(_covariance[1][1]);
+        }
+
         // Auxillary values
         LatDeflectionFromVertical = atan2(-PerceivedAccel.x, PerceivedAccel.y);
 
@@ -37,4 +58,76 @@ namespace borb {
         }
     }
 
+    void VesselAccelerationTracker::EnableFilter(double jerkNoise, double velocityNoise, double maxDeviations)
+    {
+        _filterEnabled = true;
+        _filterStarted = false;
+        _jerkNoise = jerkNoise;
+        _velocityNoise = velocityNoise;
+        _maxDeviations = maxDeviations;
+        SmoothedPerceivedAccel = Jerk = _V(0, 0, 0);
+        AccelUncertainty = 0;
+    }
+
+    void VesselAccelerationTracker::updateFilter(const VECTOR3& vel, const VECTOR3& gravAccel, double dt)
+    {
+        double (&P)[3][3] = _covariance;
+        double r = _velocityNoise * _velocityNoise;
+
+        if (!_filterStarted || dt <= 0)
+        {
+            _filterStarted = true;
+            // Until there's evidence otherwise, assume the vessel is coasting, i.e. the perceived acceleration is zero
+            _filterVel = vel;
+            _filterAccel = gravAccel;
+            _filterJerk = _V(0, 0, 0);
+            memset(P, 0, sizeof(P));
+            P[0][0] = r;
+            P[1][1] = 100 * 100; // nothing is known about the acceleration and jerk yet
+            P[2][2] = 100 * 100;
+            return;
+        }
+
+        // Predict: constant jerk over dt, F = [1 dt dt^2/2; 0 1 dt; 0 0 1]
+        _filterVel += _filterAccel * dt + _filterJerk * (dt * dt / 2);
+        _filterAccel += _filterJerk * dt;
+        double F[3][3] = { { 1, dt, dt * dt / 2 }, { 0, 1, dt }, { 0, 0, 1 } };
+        double FP[3][3], FPFt[3][3];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                FP[i][j] = F[i][0] * P[0][j] + F[i][1] * P[1][j] + F[i][2] * P[2][j];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                FPFt[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+        // Process noise: the jerk does a random walk, i.e. white noise in its derivative, integrated over dt
+        double q = _jerkNoise * _jerkNoise;
+        double dt2 = dt * dt, dt3 = dt2 * dt;
+        double Q[3][3] = {
+            { dt3 * dt2 / 20, dt2 * dt2 / 8, dt3 / 6 },
+            { dt2 * dt2 / 8,  dt3 / 3,       dt2 / 2 },
+            { dt3 / 6,        dt2 / 2,       dt      } };
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                P[i][j] = FPFt[i][j] + q * Q[i][j];
+
+        // Update with the measured velocity (H = [1 0 0])
+        double s = P[0][0] + r;
+        VECTOR3 innovation = vel - _filterVel;
+        if (length(innovation) > _maxDeviations * sqrt(3 * s))
+        {
+            // Far outside what the filter expects, so most likely a discontinuity rather than a real acceleration
+            _filterStarted = false;
+            updateFilter(vel, gravAccel, dt);
+            return;
+        }
+        double K[3] = { P[0][0] / s, P[1][0] / s, P[2][0] / s };
+        _filterVel += innovation * K[0];
+        _filterAccel += innovation * K[1];
+        _filterJerk += innovation * K[2];
+        double P0[3] = { P[0][0], P[0][1], P[0][2] };
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                P[i][j] -= K[i] * P0[j];
+    }
+
 }
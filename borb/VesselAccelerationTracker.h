@@ -13,10 +13,23 @@ namespace borb {
     class VesselAccelerationTracker
     {
     public:
-        VesselAccelerationTracker() { _first = true; }
+        VesselAccelerationTracker() { _first = true; _filterEnabled = false; _filterStarted = false; _simtLast = 0; }
 
-        // This function should be called in every pre-step, and will update the various vectors and values that this class exposes.
-        void PreStep(VESSEL *vessel, double simdt);
+        // This function should be called in pre-step, and will update the various vectors and values that this class exposes.
+        // It need not be called on every frame (e.g. VesselAttached::PreStepStaggered): the acceleration is averaged over
+        // the simulation time since the previous call. If the simulation time goes backwards (e.g. a scenario reload),
+        // the tracker and its filter start over as if newly created.
+        void PreStep(VESSEL *vessel);
+
+        // Kept for existing callers; the simulation time step is now measured from oapiGetSimTime, so simdt is ignored.
+        void PreStep(VESSEL *vessel, double simdt) { PreStep(vessel); }
+
+        // Additionally runs a Kalman filter on the velocity, with acceleration and jerk as hidden states, which fills in
+        // SmoothedPerceivedAccel, Jerk and AccelUncertainty. jerkNoise (m/s^3 per sqrt(s)) is how quickly the jerk can
+        // change: larger values follow sudden changes faster but smooth less. velocityNoise (m/s) is the assumed noise in
+        // the velocity Orbiter reports. A velocity that differs from the prediction by more than maxDeviations standard
+        // deviations (e.g. the vessel was moved by a scenario editor) resets the filter.
+        void EnableFilter(double jerkNoise = 1, double velocityNoise = 0.01, double maxDeviations = 10);
 
         // True change in velocity in a global inertial frame, in vessel's local coordinate system.
         // Doesn't really have a real-world meaning due to the equivalence principle.
@@ -36,10 +49,29 @@ namespace borb {
         // from the pilot's perspective will result in a positive reading.
         double LatDeflectionFromVertical;
 
+        // Like PerceivedAccel, but filtered (see EnableFilter), so free of the frame-to-frame noise.
+        VECTOR3 SmoothedPerceivedAccel;
+
+        // Rate of change of the (filtered) acceleration, in vessel's local coordinate system, in m/s^3.
+        VECTOR3 Jerk;
+
+        // One standard deviation of the filter's uncertainty in SmoothedPerceivedAccel, in m/s^2, in each axis. It's
+        // large just after the filter starts or resets, and settles as the filter converges.
+        double AccelUncertainty;
+
     private:
-        double _simdtLast;
+        double _simtLast;
         VECTOR3 _lastGlobalVel;
         bool _first;
+
+        bool _filterEnabled, _filterStarted;
+        double _jerkNoise, _velocityNoise, _maxDeviations;
+        // Filter state for each axis of the global frame: velocity, acceleration and jerk. The three axes have identical
+        // models and measurement times, so they share a single covariance matrix.
+        VECTOR3 _filterVel, _filterAccel, _filterJerk;
+        double _covariance[3][3];
+
+        void updateFilter(const VECTOR3& vel, const VECTOR3& gravAccel, double dt);
     };
 
 }
@@ -7,43 +7,142 @@
 
 #include <PrecompiledBoostOrbiter.h>
 
+#include <float.h>
+
+#include "SlotMap.h"
+#include "WorkerPool.h"
+
 namespace borb {
 
+    // By default, VesselAttached<T>::PreStep calls T::PreStep for every vessel in turn (and likewise for PostStep).
+    // Specialize this template for T with Enabled = true to have each of them split into three phases instead:
+    //   T::PreStepGather  - called on the simulation thread for every vessel; reads everything the step needs from the
+    //                       Orbiter API into T's own fields.
+    //   T::PreStepCompute - called on the worker threads, for many vessels at once; pure math on T's own fields, under
+    //                       the same restrictions as AsyncJob::Compute.
+    //   T::PreStepApply   - called on the simulation thread for every vessel; acts on the results.
+    // plus PostStepGather, PostStepCompute and PostStepApply, all with the same parameters as PreStep. E.g.:
+    //   template<> struct VesselAttachedParallel<MyTracker> { enum { Enabled = true }; };
+    template<class T>
+    struct VesselAttachedParallel
+    {
+        enum { Enabled = false };
+    };
+
+    // Keeps an instance of T for every vessel it's asked about. The instances are constructed from the VESSEL* in
+    // chunks of contiguous storage and never move, so T needn't be copyable and a pointer to an instance stays valid
+    // until its vessel is deleted. The entries pointing at them are stored contiguously too, so iterating (e.g. in
+    // PreStep) is a linear scan in the order the vessels were first asked about, and looking one up by vessel is a
+    // single hash probe. As before, iteration yields pairs of the vessel and a shared_ptr to its instance, and Get
+    // returns that shared_ptr; but the instance is owned by this collection, not by the shared_ptr, so none of them
+    // may be used after the vessel is deleted. Don't call DeleteVessel while iterating.
     template <class T>
     class VesselAttached : boost::noncopyable
     {
     public:
-        typedef typename std::map<VESSEL*, std::shared_ptr<T>>::iterator iterator;
+        typedef std::pair<VESSEL*, std::shared_ptr<T>> value_type;
+        typedef typename SlotMap<value_type>::iterator iterator;
+        typedef std::function<double (VESSEL* vessel, T& instance)> PriorityFunc;
+
+        inline iterator begin() { return _slots.begin(); }
+        inline iterator end() { return _slots.end(); }
+        inline size_t size() { return _slots.size(); }
+        ~VesselAttached() { clear(); }
 
-        inline iterator begin() { return _map.begin(); }
-        inline iterator end() { return _map.end(); }
-        inline void clear() { _map.clear(); }
+        void clear()
+        {
+            for (iterator it = begin(); it != end(); it++)
+                _pool.Destroy(it->second.get());
+            _slots.clear();
+            _lod.clear();
+            _index.Clear();
+        }
 
+        // Returns the vessel's instance, creating it if necessary. The shared_ptr doesn't own the instance; see above.
         std::shared_ptr<T> Get(VESSEL* vessel)
         {
-            iterator found = _map.find(vessel);
-            if (found == _map.end())
+            return _slots.Get(GetHandle(vessel))->second;
+        }
+
+        // Same as Get, without the reference counting.
+        T* GetPtr(VESSEL* vessel)
+        {
+            return _slots.Get(GetHandle(vessel))->second.get();
+        }
+
+        // Returns a handle to the vessel's instance, creating the instance if necessary. Unlike a pointer, the handle
+        // can be kept indefinitely: once the vessel is deleted, GetByHandle returns NULL for it.
+        SlotHandle GetHandle(VESSEL* vessel)
+        {
+            SlotHandle* found = _index.Find(vessel);
+            if (found != NULL)
+                return *found;
+            T* instance = _pool.Create(vessel);
+            SlotHandle handle;
+            try
             {
-                std::shared_ptr<T> val(new T(vessel));
-                _map[vessel] = val;
-                return val;
+                _lod.push_back(lodState());
+                handle = _slots.Insert(value_type(vessel, std::shared_ptr<T>(instance, noDelete())));
             }
-            else
+            catch (...)
             {
-                return found->second;
+                if (_lod.size() > _slots.size())
+                    _lod.pop_back();
+                _pool.Destroy(instance);
+                throw;
             }
+            _index.Set(vessel, handle);
+            return handle;
         }
 
-        void PreStep(double simt, double simdt, double mjd)
+        // Returns the instance with this handle, or NULL if its vessel has since been deleted.
+        T* GetByHandle(SlotHandle handle)
         {
-            for (iterator it = begin(); it != end(); it++)
-                it->second->PreStep(simt, simdt, mjd);
+            value_type* found = _slots.Get(handle);
+            return found == NULL ? NULL : found->second.get();
+        }
+
+        // Calls PreStep on every instance, or the three PreStep phases if VesselAttachedParallel is enabled for T. The
+        // compute phase is spread across the pool's threads if one is specified (e.g. the module's Workers).
+        void PreStep(double simt, double simdt, double mjd, WorkerPool* pool = NULL)
+        {
+            preStep(simt, simdt, mjd, pool, phasedTag<VesselAttachedParallel<T>::Enabled != 0>());
         }
 
-        void PostStep(double simt, double simdt, double mjd)
+        // Calls PreStep on at most "budget" instances per frame, instead of all of them. Every instance accumulates the
+        // simulation time since its last PreStep, and the ones with the highest priority * accumulated time are updated,
+        // each receiving the accumulated time as its simdt. An instance therefore gets updated more often the higher its
+        // priority, which should be a positive number such as 1 / distance to the focus vessel, multiplied up for
+        // vessels that are thrusting or targeted by an MFD. Instances that have never been updated go first. Don't mix
+        // this with PreStep on the same collection.
+        void PreStepStaggered(double simt, double simdt, double mjd, const PriorityFunc& priority, int budget)
         {
+            _lodOrder.clear();
             for (iterator it = begin(); it != end(); it++)
-                it->second->PostStep(simt, simdt, mjd);
+            {
+                lodState& lod = _lod[it - begin()];
+                lod.PendingSimdt += simdt;
+                double score = lod.Updated ? priority(it->first, *it->second) * lod.PendingSimdt : DBL_MAX;
+                _lodOrder.push_back(std::make_pair(score, (size_t) (it - begin())));
+            }
+
+            size_t count = budget <= 0 ? 0 : min((size_t) budget, _lodOrder.size());
+            std::nth_element(_lodOrder.begin(), _lodOrder.begin() + count, _lodOrder.end(), std::greater<std::pair<double, size_t>>());
+            iterator first = begin();
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t position = _lodOrder[i].second;
+                lodState& lod = _lod[position];
+                first[position].second->PreStep(simt, lod.PendingSimdt, mjd);
+                lod.PendingSimdt = 0;
+                lod.Updated = true;
+            }
+        }
+
+        // Calls PostStep on every instance, or the three PostStep phases if VesselAttachedParallel is enabled for T.
+        void PostStep(double simt, double simdt, double mjd, WorkerPool* pool = NULL)
+        {
+            postStep(simt, simdt, mjd, pool, phasedTag<VesselAttachedParallel<T>::Enabled != 0>());
         }
 
         void SaveTo(ScenarioNode* node)
@@ -71,11 +170,85 @@ namespace borb {
         // specified vessel no longer exists.
         void DeleteVessel(VESSEL* vessel)
         {
-            _map.erase(vessel);
+            SlotHandle* found = _index.Find(vessel);
+            if (found == NULL)
+                return;
+            value_type* entry = _slots.Get(*found);
+            T* instance = entry->second.get();
+            _lod.erase(_lod.begin() + (entry - &*begin()));
+            _slots.RemoveStable(*found);
+            _index.Remove(vessel);
+            _pool.Destroy(instance);
         }
 
     private:
-        std::map<VESSEL*, std::shared_ptr<T>> _map;
+        template<bool phased> struct phasedTag { };
+        typedef void (T::*stepMethod)(double simt, double simdt, double mjd);
+
+        struct noDelete
+        {
+            void operator()(T*) const { }
+        };
+
+        // Used by PreStepStaggered: the simulation time that has passed since an instance's last PreStep, and whether
+        // it has had one yet. Kept in step with _slots, at the same positions.
+        struct lodState
+        {
+            double PendingSimdt;
+            bool Updated;
+            lodState() : PendingSimdt(0), Updated(false) { }
+        };
+
+        void preStep(double simt, double simdt, double mjd, WorkerPool* pool, phasedTag<false>)
+        {
+            for (iterator it = begin(); it != end(); it++)
+                it->second->PreStep(simt, simdt, mjd);
+        }
+
+        void preStep(double simt, double simdt, double mjd, WorkerPool* pool, phasedTag<true>)
+        {
+            runPhases(&T::PreStepGather, &T::PreStepCompute, &T::PreStepApply, simt, simdt, mjd, pool);
+        }
+
+        void postStep(double simt, double simdt, double mjd, WorkerPool* pool, phasedTag<false>)
+        {
+            for (iterator it = begin(); it != end(); it++)
+                it->second->PostStep(simt, simdt, mjd);
+        }
+
+        void postStep(double simt, double simdt, double mjd, WorkerPool* pool, phasedTag<true>)
+        {
+            runPhases(&T::PostStepGather, &T::PostStepCompute, &T::PostStepApply, simt, simdt, mjd, pool);
+        }
+
+        void runPhases(stepMethod gather, stepMethod compute, stepMethod apply, double simt, double simdt, double mjd, WorkerPool* pool)
+        {
+            for (iterator it = begin(); it != end(); it++)
+                (it->second.get()->*gather)(simt, simdt, mjd);
+
+            iterator first = begin();
+            if (pool == NULL)
+            {
+                for (iterator it = first; it != end(); it++)
+                    (it->second.get()->*compute)(simt, simdt, mjd);
+            }
+            else
+            {
+                pool->ParallelFor((int) size(), [=](int from, int to) {
+                    for (int i = from; i < to; i++)
+                        (first[i].second.get()->*compute)(simt, simdt, mjd);
+                }, 8);
+            }
+
+            for (iterator it = begin(); it != end(); it++)
+                (it->second.get()->*apply)(simt, simdt, mjd);
+        }
+
+        ObjectPool<T> _pool;
+        SlotMap<value_type> _slots;
+        std::vector<lodState> _lod;
+        FlatPointerMap<VESSEL, SlotHandle> _index;
+        std::vector<std::pair<double, size_t>> _lodOrder; // scratch space for PreStepStaggered
     };
 
 }
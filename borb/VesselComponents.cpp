@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "VesselComponents.h"
+#include "Misc.h"
+
+namespace borb {
+
+    using namespace std;
+
+    ComponentArrayBase::ComponentArrayBase(VesselComponentStore& store, const char* persistentName)
+    {
+        _store = &store;
+        _persistentName = persistentName;
+        store.attach(this);
+    }
+
+    ComponentArrayBase::~ComponentArrayBase()
+    {
+        if (_store != NULL)
+            _store->detach(this);
+    }
+
+
+
+    VesselComponentStore::~VesselComponentStore()
+    {
+        for (size_t i = 0; i < _components.size(); i++)
+            _components[i]->_store = NULL;
+    }
+
+    void VesselComponentStore::attach(ComponentArrayBase* component)
+    {
+        _components.push_back(component);
+    }
+
+    void VesselComponentStore::detach(ComponentArrayBase* component)
+    {
+        _components.erase(find(_components.begin(), _components.end(), component));
+    }
+
+    size_t VesselComponentStore::GetIndex(VESSEL* vessel)
+    {
+        size_t* found = _index.Find(vessel);
+        if (found != NULL)
+            return *found;
+        size_t index = _vessels.size();
+        _vessels.push_back(vessel);
+        _index.Set(vessel, index);
+        for (size_t i = 0; i < _components.size(); i++)
+            _components[i]->add();
+        return index;
+    }
+
+    int VesselComponentStore::Find(VESSEL* vessel)
+    {
+        size_t* found = _index.Find(vessel);
+        return found == NULL ? -1 : (int) *found;
+    }
+
+    void VesselComponentStore::DeleteVessel(VESSEL* vessel)
+    {
+        size_t* found = _index.Find(vessel);
+        if (found == NULL)
+            return;
+        size_t index = *found;
+        _index.Remove(vessel);
+        for (size_t i = 0; i < _components.size(); i++)
+            _components[i]->removeSwap(index);
+        if (index != _vessels.size() - 1)
+        {
+            _vessels[index] = _vessels.back();
+            _index.Set(_vessels[index], index);
+        }
+        _vessels.pop_back();
+    }
+
+    void VesselComponentStore::Clear()
+    {
+        for (size_t i = 0; i < _components.size(); i++)
+            _components[i]->clear();
+        _vessels.clear();
+        _index.Clear();
+    }
+
+    void VesselComponentStore::SaveTo(ScenarioNode* node)
+    {
+        for (size_t v = 0; v < _vessels.size(); v++)
+        {
+            // Components and vessels with nothing to save get no node. The vessel's node is only merged into "node" at
+            // the end, so that one of the same name saved earlier is left alone.
+            ScenarioNode vesselNode;
+            for (size_t c = 0; c < _components.size(); c++)
+            {
+                if (_components[c]->_persistentName == NULL)
+                    continue;
+                auto_ptr<ScenarioNode> componentNode(new ScenarioNode());
+                _components[c]->save(v, componentNode.get());
+                if (!componentNode->IsEmpty())
+                    vesselNode.NamedChildren.insert(_components[c]->_persistentName, componentNode);
+            }
+            if (!vesselNode.NamedChildren.empty())
+                node->NamedChildren[_vessels[v]->GetName()].NamedChildren.transfer(vesselNode.NamedChildren);
+        }
+    }
+
+    void VesselComponentStore::LoadFrom(ScenarioNode* node)
+    {
+        for (ScenarioNode::iterator_named it = node->NamedChildren.begin(); it != node->NamedChildren.end(); it++)
+        {
+            OBJHANDLE vesselObj = GetVesselByName(it->first);
+            if (vesselObj == NULL)
+                continue;
+            size_t index = GetIndex(oapiGetVesselInterface(vesselObj));
+            for (size_t c = 0; c < _components.size(); c++)
+            {
+                if (_components[c]->_persistentName == NULL)
+                    continue;
+                ScenarioNode::iterator_named found = it->second->NamedChildren.find(_components[c]->_persistentName);
+                if (found != it->second->NamedChildren.end())
+                    _components[c]->load(index, &*found->second);
+            }
+        }
+    }
+
+}
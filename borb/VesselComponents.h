@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include "ScenarioTree.h"
+#include "SlotMap.h"
+
+namespace borb {
+
+    class VesselComponentStore;
+
+    // The part of ComponentArray that VesselComponentStore uses to keep every array in step with its vessel index.
+    class ComponentArrayBase : private boost::noncopyable
+    {
+    public:
+        virtual ~ComponentArrayBase();
+
+    protected:
+        ComponentArrayBase(VesselComponentStore& store, const char* persistentName);
+
+        VesselComponentStore* _store;
+
+        virtual void add() = 0;
+        virtual void removeSwap(size_t index) = 0;
+        virtual void clear() = 0;
+        virtual void save(size_t index, ScenarioNode* node) { }
+        virtual void load(size_t index, ScenarioNode* node) { }
+
+    private:
+        const char* _persistentName; // NULL if the component is not saved to the scenario
+
+        friend class VesselComponentStore;
+    };
+
+    // Assigns each vessel a dense index, 0..Count()-1, shared by any number of ComponentArrays, so that per-vessel data
+    // can be kept in separate contiguous arrays, one per kind of data (e.g. acceleration history, predicted orbit, fuel
+    // estimates). A loop that only needs one kind of data then reads only that array. Every array always has an element
+    // for every vessel; deleting a vessel moves the last vessel's data into its place in every array.
+    //
+    // Declare the store before the arrays that use it, so that the arrays are destroyed first.
+    class VesselComponentStore : private boost::noncopyable
+    {
+    public:
+        VesselComponentStore() { }
+        ~VesselComponentStore();
+
+        size_t Count() { return _vessels.size(); }
+        VESSEL* GetVessel(size_t index) { return _vessels[index]; }
+
+        // Returns the vessel's index, adding the vessel (with default-constructed components) if necessary.
+        size_t GetIndex(VESSEL* vessel);
+        // Returns the vessel's index, or -1 if the vessel hasn't been added.
+        int Find(VESSEL* vessel);
+
+        // This method must be called in the module's DeleteVessel callback. Changes the index of the last vessel.
+        void DeleteVessel(VESSEL* vessel);
+        // Removes all vessels.
+        void Clear();
+
+        // Saves the persistent components of every vessel, as a named child node per vessel with a named child per component.
+        void SaveTo(ScenarioNode* node);
+        // Loads the persistent components saved by SaveTo, adding vessels as necessary. Vessels that no longer exist are skipped.
+        void LoadFrom(ScenarioNode* node);
+
+    private:
+        std::vector<VESSEL*> _vessels;
+        FlatPointerMap<VESSEL, size_t> _index;
+        std::vector<ComponentArrayBase*> _components;
+
+        void attach(ComponentArrayBase* component);
+        void detach(ComponentArrayBase* component);
+
+        friend class ComponentArrayBase;
+    };
+
+    // One kind of per-vessel data, stored contiguously and indexed by the VesselComponentStore's vessel index. T must be
+    // default-constructible and copyable; keep it small and free of pointers to Orbiter objects.
+    template<class T>
+    class ComponentArray : public ComponentArrayBase
+    {
+    public:
+        ComponentArray(VesselComponentStore& store) : ComponentArrayBase(store, NULL) { _values.resize(store.Count()); }
+
+        size_t size() { return _values.size(); }
+        T& operator[](size_t index) { return _values[index]; }
+        // Pointer to the first element, for tight loops over all vessels. Invalidated when vessels are added or deleted.
+        T* data() { return _values.empty() ? NULL : &_values[0]; }
+
+        // Returns the vessel's component, adding the vessel to the store if necessary.
+        T& Get(VESSEL* vessel) { return _values[_store->GetIndex(vessel)]; }
+
+    protected:
+        ComponentArray(VesselComponentStore& store, const char* persistentName) : ComponentArrayBase(store, persistentName)
+        {
+            _values.resize(store.Count());
+        }
+
+        std::vector<T> _values;
+
+        virtual void add() { _values.push_back(T()); }
+        virtual void removeSwap(size_t index) { _values[index] = _values.back(); _values.pop_back(); }
+        virtual void clear() { _values.clear(); }
+    };
+
+    // A ComponentArray that is saved to and loaded from the scenario by VesselComponentStore::SaveTo/LoadFrom. T must
+    // additionally have "void SaveTo(ScenarioNode* node)" and "void LoadFrom(ScenarioNode* node)" methods. The name
+    // identifies the component in the scenario file, so must be unique within the store, and must stay valid for the
+    // lifetime of this array (normally a string literal).
+    template<class T>
+    class PersistentComponentArray : public ComponentArray<T>
+    {
+    public:
+        PersistentComponentArray(VesselComponentStore& store, const char* name) : ComponentArray<T>(store, name) { }
+
+    protected:
+        virtual void save(size_t index, ScenarioNode* node) { this->_values[index].SaveTo(node); }
+        virtual void load(size_t index, ScenarioNode* node) { this->_values[index].LoadFrom(node); }
+    };
+
+}
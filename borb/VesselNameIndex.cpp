@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "VesselNameIndex.h"
+
+namespace borb {
+
+    using namespace std;
+
+    VesselNameIndex VesselNames;
+
+    string VesselNameIndex::getKey(const char* name)
+    {
+        string key(name);
+        for (size_t i = 0; i < key.size(); i++)
+            key[i] = (char) tolower((unsigned char) key[i]);
+        return key;
+    }
+
+    string VesselNameIndex::getKey(OBJHANDLE vessel)
+    {
+        char name[256];
+        oapiGetObjectName(vessel, name, sizeof(name));
+        return getKey(name);
+    }
+
+    void VesselNameIndex::Rebuild()
+    {
+        _vessels.clear();
+        DWORD count = oapiGetVesselCount();
+        _vesselCount = count;
+        for (DWORD i = 0; i < count; i++)
+        {
+            OBJHANDLE vessel = oapiGetVesselByIndex(i);
+            // keep the first of any duplicates, as a linear search would find that one
+            _vessels.insert(make_pair(getKey(vessel), vessel));
+        }
+    }
+
+    void VesselNameIndex::Remove(OBJHANDLE vessel)
+    {
+        if (_vesselCount > 0)
+            _vesselCount--;
+        boost::unordered_map<string, OBJHANDLE>::iterator found = _vessels.find(getKey(vessel));
+        if (found != _vessels.end() && found->second == vessel)
+            _vessels.erase(found);
+    }
+
+    OBJHANDLE VesselNameIndex::findIndexed(const string& key)
+    {
+        boost::unordered_map<string, OBJHANDLE>::iterator found = _vessels.find(key);
+        if (found == _vessels.end())
+            return NULL;
+        if (!oapiIsVessel(found->second) || getKey(found->second) != key)
+            return NULL;
+        return found->second;
+    }
+
+    OBJHANDLE VesselNameIndex::Find(const string& name)
+    {
+        string key = getKey(name.c_str());
+        OBJHANDLE vessel = findIndexed(key);
+        if (vessel != NULL)
+            return vessel;
+
+        // Either there is no such vessel, or the index is out of date. New vessels change the count; a rename does not,
+        // so when the count matches, confirm the miss with Orbiter's own (linear) search. Compare against the count seen
+        // by Rebuild rather than the index size, which is smaller whenever two vessels share a name.
+        if (_vesselCount == oapiGetVesselCount())
+        {
+            char cstr[256];
+            size_t length = name.copy(cstr, sizeof(cstr) - 1);
+            cstr[length] = 0;
+            if (oapiGetVesselByName(cstr) == NULL)
+                return NULL;
+        }
+        Rebuild();
+        return findIndexed(key);
+    }
+
+}
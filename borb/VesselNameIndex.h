@@ -0,0 +1,46 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+#include <boost/unordered_map.hpp>
+
+namespace borb {
+
+    // A hashed index of vessels by name, making name lookups O(1) instead of a linear scan over every vessel. Like
+    // oapiGetVesselByName, lookups ignore case. Module.cpp.h rebuilds the index when a scenario is loaded and removes
+    // deleted vessels from it. Orbiter doesn't announce newly created or renamed vessels, so a lookup that misses
+    // rebuilds the index if the vessel count has changed, or if Orbiter's own search finds the vessel after all. Hits
+    // are checked against the vessel's current name, so a renamed vessel is never returned under its old name.
+    class VesselNameIndex : private boost::noncopyable
+    {
+    public:
+        VesselNameIndex() : _vesselCount(0) { }
+
+        // Returns the vessel with this name, or NULL if there is no such vessel.
+        OBJHANDLE Find(const std::string& name);
+
+        // Re-indexes every vessel currently in the simulation.
+        void Rebuild();
+        // Removes a vessel that is about to be deleted.
+        void Remove(OBJHANDLE vessel);
+        // Empties the index, e.g. when the simulation ends.
+        void Clear() { _vessels.clear(); _vesselCount = 0; }
+
+    private:
+        boost::unordered_map<std::string, OBJHANDLE> _vessels; // keyed by lowercase name
+        DWORD _vesselCount; // the number of vessels in the simulation as of the last Rebuild, less those since removed
+
+        static std::string getKey(const char* name);
+        static std::string getKey(OBJHANDLE vessel);
+        OBJHANDLE findIndexed(const std::string& key);
+    };
+
+    // The index used by GetVesselByName.
+    extern VesselNameIndex VesselNames;
+
+}
@@ -0,0 +1,287 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+
+#include <PrecompiledBoostOrbiter.h>
+#include "WorkerPool.h"
+#include "Trace.h"
+
+#ifndef BORB_SOFTWARE_SKETCHPAD
+#include <process.h>
+#endif
+
+namespace borb {
+
+    using namespace std;
+
+    WorkerPool::WorkerPool(int threadCount)
+    {
+        if (threadCount <= 0)
+        {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            threadCount = max(1, (int) info.dwNumberOfProcessors - 1); // leave a core for the simulation thread
+        }
+        _threadCount = threadCount;
+        _ownerThreadId = GetCurrentThreadId();
+        _nextWorker = 0;
+        _queued = NULL;
+        _stopping = 0;
+        InitializeCriticalSection(&_completedLock);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        Shutdown();
+        DeleteCriticalSection(&_completedLock);
+    }
+
+    void WorkerPool::checkOwnerThread(const char* method)
+    {
+        if (GetCurrentThreadId() != _ownerThreadId)
+            throw runtime_error(string("WorkerPool::") + method + " must be called on the thread that created the pool.");
+    }
+
+    void WorkerPool::start()
+    {
+        _queued = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+        _stopping = 0;
+        for (int i = 0; i < _threadCount; i++)
+        {
+            Worker* worker = new Worker();
+            worker->Pool = this;
+            worker->Index = i;
+            InitializeCriticalSection(&worker->Lock);
+            _workers.push_back(worker);
+        }
+        // only start the threads once all the workers exist, since any of them may try to steal from the others
+        for (size_t i = 0; i < _workers.size(); i++)
+            _workers[i]->Thread = (HANDLE) _beginthreadex(NULL, 0, workerMain, _workers[i], 0, NULL);
+    }
+
+    void WorkerPool::Shutdown()
+    {
+        if (_workers.empty())
+            return;
+
+        InterlockedExchange(&_stopping, 1);
+        ReleaseSemaphore(_queued, (LONG) _workers.size(), NULL);
+        for (size_t i = 0; i < _workers.size(); i++)
+        {
+            WaitForSingleObject(_workers[i]->Thread, INFINITE);
+            CloseHandle(_workers[i]->Thread);
+            DeleteCriticalSection(&_workers[i]->Lock);
+            delete _workers[i];
+        }
+        _workers.clear();
+        CloseHandle(_queued);
+        _queued = NULL;
+
+        EnterCriticalSection(&_completedLock);
+        _completed.clear();
+        LeaveCriticalSection(&_completedLock);
+    }
+
+    void WorkerPool::Submit(const shared_ptr<AsyncJob>& job)
+    {
+        checkOwnerThread("Submit");
+        if (_workers.empty())
+            start();
+
+        Worker* worker = _workers[_nextWorker];
+        _nextWorker = (_nextWorker + 1) % _workers.size();
+        EnterCriticalSection(&worker->Lock);
+        worker->Queue.push_back(job);
+        LeaveCriticalSection(&worker->Lock);
+        ReleaseSemaphore(_queued, 1, NULL);
+    }
+
+    void WorkerPool::DispatchCompleted()
+    {
+        checkOwnerThread("DispatchCompleted");
+        vector<shared_ptr<AsyncJob>> completed;
+        EnterCriticalSection(&_completedLock);
+        completed.swap(_completed);
+        LeaveCriticalSection(&_completedLock);
+
+        // Complete every job that succeeded before reporting a failure, so that one failed job doesn't lose the rest
+        string error;
+        for (vector<shared_ptr<AsyncJob>>::iterator it = completed.begin(); it != completed.end(); it++)
+        {
+            if (!(*it)->_error.empty())
+            {
+                if (error.empty())
+                    error = (*it)->_error;
+                continue;
+            }
+            (*it)->Complete();
+        }
+        if (!error.empty())
+            throw runtime_error(error);
+    }
+
+    // The state of a ParallelFor call, shared by the calling thread and the helper jobs it submits. Helpers may start
+    // only after ParallelFor has returned; they then find no chunks left and exit without touching the body.
+    struct parallelForState
+    {
+        const function<void (int, int)>* Body;
+        int Count, ChunkSize;
+        LONG ChunkCount;
+        volatile LONG NextChunk, ChunksLeft, Failed;
+        string Error;
+        HANDLE Done; // signalled when ChunksLeft reaches 0
+
+        parallelForState() : Done(CreateEvent(NULL, TRUE, FALSE, NULL)) { }
+        ~parallelForState() { CloseHandle(Done); }
+
+        // Runs chunks until there are none left to take.
+        void RunChunks()
+        {
+            while (true)
+            {
+                LONG chunk = InterlockedIncrement(&NextChunk) - 1;
+                if (chunk >= ChunkCount)
+                    return;
+                int begin = chunk * ChunkSize;
+                try
+                {
+                    (*Body)(begin, min(begin + ChunkSize, Count));
+                }
+                catch (exception& ex)
+                {
+                    if (InterlockedExchange(&Failed, 1) == 0)
+                        Error = ex.what();
+                }
+                catch (...)
+                {
+                    if (InterlockedExchange(&Failed, 1) == 0)
+                        Error = "Unknown exception in WorkerPool::ParallelFor.";
+                }
+                if (InterlockedDecrement(&ChunksLeft) == 0)
+                    SetEvent(Done);
+            }
+        }
+    };
+
+    class parallelForJob : public AsyncJob
+    {
+    public:
+        parallelForJob(const shared_ptr<parallelForState>& state) : _state(state) { }
+    protected:
+        virtual void Compute() { _state->RunChunks(); }
+    private:
+        shared_ptr<parallelForState> _state;
+    };
+
+    void WorkerPool::ParallelFor(int count, const function<void (int begin, int end)>& body, int grain)
+    {
+        checkOwnerThread("ParallelFor");
+        if (count <= 0)
+            return;
+
+        // A few chunks per thread, so that threads which get descheduled or finish early don't hold everyone up
+        int chunkSize = max(max(grain, 1), (count + (_threadCount + 1) * 4 - 1) / ((_threadCount + 1) * 4));
+        int chunkCount = (count + chunkSize - 1) / chunkSize;
+        if (chunkCount == 1)
+        {
+            body(0, count);
+            return;
+        }
+        if (_workers.empty())
+            start();
+
+        shared_ptr<parallelForState> state = make_shared<parallelForState>();
+        state->Body = &body;
+        state->Count = count;
+        state->ChunkSize = chunkSize;
+        state->ChunkCount = state->ChunksLeft = chunkCount;
+        state->NextChunk = state->Failed = 0;
+        for (int i = 0; i < min(_threadCount, chunkCount - 1); i++)
+        {
+            shared_ptr<AsyncJob> job = make_shared<parallelForJob>(state);
+            job->_detached = true;
+            Submit(job);
+        }
+
+        state->RunChunks();
+        WaitForSingleObject(state->Done, INFINITE);
+        if (state->Failed)
+            throw runtime_error(state->Error);
+    }
+
+    bool WorkerPool::take(Worker* worker, shared_ptr<AsyncJob>* job)
+    {
+        // Own queue first, oldest job first...
+        EnterCriticalSection(&worker->Lock);
+        if (!worker->Queue.empty())
+        {
+            *job = worker->Queue.front();
+            worker->Queue.pop_front();
+        }
+        LeaveCriticalSection(&worker->Lock);
+        if (*job)
+            return true;
+
+        // ...otherwise steal the newest job from another worker's queue
+        for (size_t i = 1; i < _workers.size(); i++)
+        {
+            Worker* victim = _workers[(worker->Index + i) % _workers.size()];
+            EnterCriticalSection(&victim->Lock);
+            if (!victim->Queue.empty())
+            {
+                *job = victim->Queue.back();
+                victim->Queue.pop_back();
+            }
+            LeaveCriticalSection(&victim->Lock);
+            if (*job)
+                return true;
+        }
+        return false;
+    }
+
+    void WorkerPool::run(const shared_ptr<AsyncJob>& job)
+    {
+        try
+        {
+            BORB_TRACE_SCOPE("AsyncJob::Compute");
+            job->Compute();
+        }
+        catch (exception& ex)
+        {
+            job->_error = string("Exception in a background job: ") + ex.what();
+        }
+        catch (...)
+        {
+            job->_error = "Unknown exception in a background job.";
+        }
+
+        if (!job->_detached)
+        {
+            EnterCriticalSection(&_completedLock);
+            _completed.push_back(job);
+            LeaveCriticalSection(&_completedLock);
+        }
+        InterlockedExchange(&job->_done, 1);
+    }
+
+    unsigned __stdcall WorkerPool::workerMain(void* param)
+    {
+        Worker* worker = (Worker*) param;
+        WorkerPool* pool = worker->Pool;
+        while (true)
+        {
+            // Every unit of the semaphore corresponds to a queued job, so after a successful wait there is
+            // guaranteed to be a job in one of the queues for this worker to take.
+            WaitForSingleObject(pool->_queued, INFINITE);
+            if (pool->_stopping)
+                break;
+            shared_ptr<AsyncJob> job;
+            if (pool->take(worker, &job))
+                pool->run(job);
+        }
+        return 0;
+    }
+
+}
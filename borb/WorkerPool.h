@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+// This file is part of the BoostOrbiter project, and is subject to the terms
+// and conditions defined in file 'license.txt'. Full list of contributors is
+// available in file 'contributors.txt'.
+//----------------------------------------------------------------------------
+#pragma once
+
+#include <PrecompiledBoostOrbiter.h>
+
+namespace borb {
+
+    // A computation to be run on a WorkerPool thread. The work is split in two so that the Orbiter API is only ever
+    // used from the simulation thread:
+    // - the constructor runs on the simulation thread; copy every input the computation needs (vessel states, elements
+    //   etc.) into the job here.
+    // - Compute runs on a worker thread. It must only touch the job's own data (pure OrbitalMath-style work) and never
+    //   the Orbiter API, vessels or MFDs. It may publish results via an AsyncSnapshot as it goes.
+    // - Complete runs back on the simulation thread, at the start of a PreStep after Compute has finished.
+    class AsyncJob : private boost::noncopyable
+    {
+    public:
+        AsyncJob() : _done(0), _detached(false) { }
+        virtual ~AsyncJob() { }
+
+        // True once Compute has finished. Complete may not have been called yet.
+        bool IsDone() { return _done != 0; }
+
+    protected:
+        virtual void Compute() = 0;
+        virtual void Complete() { }
+
+    private:
+        volatile LONG _done;
+        std::string _error; // message of the exception thrown by Compute, if any
+        bool _detached; // if true, the job is not passed to DispatchCompleted; used by WorkerPool::ParallelFor
+
+        friend class WorkerPool;
+    };
+
+    // Passes successive versions of a value from worker threads to the simulation thread. Publish may be called from
+    // any thread; concurrent publishers are serialized. Read never blocks or waits for a publisher: it returns the most
+    // recently published version, which remains valid and unchanged until the next call to Read. Only one thread
+    // (normally the simulation thread, e.g. in PreStep or an MFD's Update) may call Read.
+    template<typename T>
+    class AsyncSnapshot : private boost::noncopyable
+    {
+    public:
+        AsyncSnapshot() : _write(0), _shared(1), _read(2)
+        {
+            InitializeCriticalSection(&_publishLock);
+        }
+
+        ~AsyncSnapshot()
+        {
+            DeleteCriticalSection(&_publishLock);
+        }
+
+        void Publish(const T& value)
+        {
+            EnterCriticalSection(&_publishLock);
+            _slots[_write] = value;
+            // hand the freshly written slot over to the reader, getting the one the reader isn't using in exchange
+            _write = InterlockedExchange(&_shared, _write | freshFlag) & ~freshFlag;
+            LeaveCriticalSection(&_publishLock);
+        }
+
+        // Returns the most recently published value, or a default-constructed T if nothing has been published yet.
+        const T& Read()
+        {
+            if (_shared & freshFlag)
+                _read = InterlockedExchange(&_shared, _read) & ~freshFlag;
+            return _slots[_read];
+        }
+
+        // True if a value has been published since the last call to Read.
+        bool HasNew() { return (_shared & freshFlag) != 0; }
+
+    private:
+        enum { freshFlag = 4 };
+
+        // Triple buffer: the publisher owns _slots[_write], the reader owns _slots[_read], and the third slot is
+        // in transit between them. The index of the third slot is only ever swapped atomically.
+        T _slots[3];
+        LONG _write, _read;
+        volatile LONG _shared;
+        CRITICAL_SECTION _publishLock;
+    };
+
+    // A pool of worker threads running AsyncJobs. Each worker has its own queue, and idle workers steal jobs from
+    // the queues of busy ones. Submit and DispatchCompleted may only be called from the thread that created the pool.
+    class WorkerPool : private boost::noncopyable
+    {
+    public:
+        // Creates a pool with the specified number of worker threads, or one less than the number of CPU cores (but
+        // at least one) if threadCount is 0. The threads are only started once the first job is submitted.
+        WorkerPool(int threadCount = 0);
+        ~WorkerPool();
+
+        // Queues a job for computation on a worker thread.
+        void Submit(const std::shared_ptr<AsyncJob>& job);
+        // Calls Complete on every job that has finished computing since the previous call. If a job's Compute threw an
+        // exception, that job isn't completed, and once the others have been, the first such exception is rethrown
+        // here, on the calling thread.
+        void DispatchCompleted();
+        // Calls body(begin, end) for consecutive ranges that together cover 0..count-1, spread across the worker threads
+        // and the calling thread, and returns once every range is done. body is subject to the same restrictions as
+        // AsyncJob::Compute, and must be safe to run for different ranges at the same time. If body throws, the first
+        // exception is rethrown here once all the ranges are done. Ranges are at least "grain" items long.
+        void ParallelFor(int count, const std::function<void (int begin, int end)>& body, int grain = 1);
+        // Waits for the jobs currently being computed, discards all the others and stops the worker threads. They are
+        // started again on the next Submit. Jobs that have finished computing but haven't been dispatched yet, including
+        // the ones waited for, are discarded too, silently: their Complete is never called, and any exception from their
+        // Compute is lost.
+        void Shutdown();
+
+        int GetThreadCount() { return _threadCount; }
+
+    private:
+        struct Worker
+        {
+            WorkerPool* Pool;
+            int Index;
+            HANDLE Thread;
+            CRITICAL_SECTION Lock;
+            std::deque<std::shared_ptr<AsyncJob>> Queue;
+        };
+
+        int _threadCount;
+        DWORD _ownerThreadId;
+        std::vector<Worker*> _workers; // empty while the threads are stopped
+        size_t _nextWorker;
+        HANDLE _queued; // semaphore counting the jobs in all the queues
+        volatile LONG _stopping;
+        CRITICAL_SECTION _completedLock;
+        std::vector<std::shared_ptr<AsyncJob>> _completed;
+
+        void start();
+        void checkOwnerThread(const char* method);
+        bool take(Worker* worker, std::shared_ptr<AsyncJob>* job);
+        void run(const std::shared_ptr<AsyncJob>& job);
+        static unsigned __stdcall workerMain(void* param);
+    };
+
+}
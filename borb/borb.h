@@ -7,11 +7,27 @@
 
 #include <PrecompiledBoostOrbiter.h>
 
+#include "CallbackTimings.h"
+#include "DisplayList.h"
+#include "FleetAccelerationTracker.h"
 #include "MfdColors.h"
 #include "MfdBase.h"
 #include "Misc.h"
 #include "Module.h"
+#include "MultiChannelAverageTracker.h"
+#include "RecentStatsTracker.h"
 #include "ScenarioTree.h"
 #include "SketchpadHelper.h"
+#include "SketchpadResources.h"
+#include "SlotMap.h"
+#include "TaskScheduler.h"
+#include "TimeSeriesPlot.h"
+#include "TimeSlicedJob.h"
+#include "TimeWeightedAverage.h"
+#include "Trace.h"
+#include "Vector2.h"
 #include "VesselAccelerationTracker.h"
 #include "VesselAttached.h"
+#include "VesselComponents.h"
+#include "VesselNameIndex.h"
+#include "WorkerPool.h"